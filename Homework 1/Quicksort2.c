@@ -2,7 +2,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
+#include <unistd.h>
 #include <sys/time.h>  // For gettimeofday()
+#include "fastprint.h"
 
 #define DEFAULT_ARRAY_SIZE         100000
 #define DEFAULT_PARALLEL_THRESHOLD   5000
@@ -80,15 +82,12 @@ void *parallelQuicksortWorker(void *arg) {
     return NULL;
 }
 
+/* Formats in parallel and writes in large blocks; see fastprint.h */
 void array_print(int *array, size_t size) {
-    printf("[");
-    if (size > 0) {
-        printf(" %i", array[0]);
-        for (size_t i = 1; i < size; i++) {
-            printf(", %i", array[i]);
-        }
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (array_write(STDOUT_FILENO, array, size, threads) < 0) {
+        fprintf(stderr, "Error writing the array\n");
     }
-    printf(" ]\n");
 }
 
 bool array_equality(int *a, int *b, size_t size) {
@@ -106,12 +105,13 @@ double timeDiff(struct timeval start, struct timeval end) {
 
 int main(int argc, char *argv[]) {
     if (argc == 1) {
-        printf("Usage: %s <array_size> <parallel_threshold> <print_array>\n", argv[0]);
+        printf("Usage: %s <array_size> <parallel_threshold> <print_array> <dump_file>\n", argv[0]);
     }
 
     int arraySize        = (argc > 1) ? atoi(argv[1]) : DEFAULT_ARRAY_SIZE;
     g_parallel_threshold = (argc > 2) ? atoi(argv[2]) : DEFAULT_PARALLEL_THRESHOLD;
 	bool print_array     = (argc > 3) ? atoi(argv[3]) : false;
+    const char *dumpFile = (argc > 4) ? argv[4] : NULL;
 
     printf("Array Size         : %d\n", arraySize);
     printf("Parallel Threshold : %d\n", g_parallel_threshold);
@@ -160,10 +160,20 @@ int main(int argc, char *argv[]) {
         printf("Parallel quicksort was %.2fx faster.\n", (float)serialTime / (float)parallelTime);
     }
 
+    // Measure output of the sorted array separately from the sort
+    struct timeval startOutput, endOutput;
+    gettimeofday(&startOutput, NULL);
     if (print_array) {
         array_print(array, arraySize);
         array_print(copy, arraySize);
     }
+    if (dumpFile && array_dump(dumpFile, copy, arraySize) < 0) {
+        printf("Error dumping the array to %s\n", dumpFile);
+    }
+    gettimeofday(&endOutput, NULL);
+    if (print_array || dumpFile) {
+        printf("Output Time        : %f seconds\n", timeDiff(startOutput, endOutput));
+    }
 
     free(array);
     free(copy);
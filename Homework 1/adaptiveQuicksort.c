@@ -0,0 +1,430 @@
+/* adaptive quicksort using pthreads
+
+   features: scans the input in parallel for ascending and descending
+             runs, reverses the descending ones in place and, when the
+             input consists of only a few runs, merges them with a
+             parallel (co-rank split) merge instead of repartitioning.
+             Inputs with many runs fall back to the parallel quicksort.
+
+   usage under Linux:
+     gcc -O2 adaptiveQuicksort.c -lpthread -o adaptive
+     ./adaptive <array_size> <num_threads> <input_kind>
+
+   input_kind: 0 random, 1 sorted, 2 reversed, 3 alternating runs,
+               4 nearly sorted
+*/
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/time.h>  // For gettimeofday()
+
+#define DEFAULT_ARRAY_SIZE  1000000
+#define MAXTHREADS          16
+#define THRESHOLD           100000  // Switch to serial sorting for small partitions
+#define MAX_RUNS            64      // More runs than this and we quicksort instead
+#define MIN_PARALLEL_MERGE  65536   // Merge smaller pairs with a single thread
+
+int numThreads;
+
+/* A sorted run [start, end) of the array */
+typedef struct {
+    int start;
+    int end;
+} Run;
+
+/* Swap helper function */
+void swap(int *a, int *b) {
+    int temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+/* Median-of-Three Pivot Selection */
+int medianOfThree(int left, int right, int *array) {
+    int mid = left + (right - left) / 2;
+    if (array[left] > array[mid]) swap(&array[left], &array[mid]);
+    if (array[left] > array[right]) swap(&array[left], &array[right]);
+    if (array[mid] > array[right]) swap(&array[mid], &array[right]);
+    return mid;
+}
+
+/* Partition function for quicksort */
+int partition(int left, int right, int *array) {
+    int pivotIndex = medianOfThree(left, right, array);
+    swap(&array[pivotIndex], &array[right]);
+    int pivot = array[right];
+    int i = left - 1;
+
+    for (int j = left; j < right; j++) {
+        if (array[j] < pivot) {
+            i++;
+            swap(&array[i], &array[j]);
+        }
+    }
+    swap(&array[i + 1], &array[right]);
+    return i + 1;
+}
+
+/* Serial Quicksort */
+void serialQuicksort(int left, int right, int *array) {
+    if (left < right) {
+        int pivotIndex = partition(left, right, array);
+        serialQuicksort(left, pivotIndex - 1, array);
+        serialQuicksort(pivotIndex + 1, right, array);
+    }
+}
+
+/* Struct for passing data to pthread */
+typedef struct {
+    int left;
+    int right;
+    int depth;
+    int *array;
+} QuickSortTask;
+
+void *parallelQuicksortWorker(void *arg);
+
+/* Parallel Quicksort; spawns threads only while depth allows */
+void parallelQuicksort(int left, int right, int depth, int *array) {
+    if (depth > 0 && (right - left) > THRESHOLD) {
+        int pivotIndex = partition(left, right, array);
+        pthread_t leftThread;
+        QuickSortTask task = { left, pivotIndex - 1, depth - 1, array };
+        pthread_create(&leftThread, NULL, parallelQuicksortWorker, &task);
+        parallelQuicksort(pivotIndex + 1, right, depth - 1, array);
+        pthread_join(leftThread, NULL);
+    } else {
+        serialQuicksort(left, right, array);
+    }
+}
+
+void *parallelQuicksortWorker(void *arg) {
+    QuickSortTask *task = (QuickSortTask *)arg;
+    parallelQuicksort(task->left, task->right, task->depth, task->array);
+    return NULL;
+}
+
+/* Number of spawn levels needed to keep numThreads busy */
+int spawnDepth(int threads) {
+    int depth = 0;
+    while ((1 << depth) < threads) depth++;
+    return depth;
+}
+
+/* ------------------------------------------------------------------ */
+/* Run detection                                                      */
+/* ------------------------------------------------------------------ */
+
+/* Struct for passing a chunk to a run scanner */
+typedef struct {
+    int first, last;          /* chunk is [first, last) */
+    int *array;
+    Run runs[MAX_RUNS + 1];
+    int numRuns;
+    bool overflow;            /* more than MAX_RUNS runs in this chunk */
+} ScanTask;
+
+void reverse(int *array, int first, int last) {
+    while (first < last) {
+        swap(&array[first], &array[last]);
+        first++;
+        last--;
+    }
+}
+
+/* Split a chunk into maximal runs, reversing strictly descending ones.
+   Gives up as soon as the chunk alone has too many runs to merge. */
+void *scanWorker(void *arg) {
+    ScanTask *task = (ScanTask *)arg;
+    int *a = task->array;
+    int i = task->first;
+
+    task->numRuns = 0;
+    task->overflow = false;
+    while (i < task->last) {
+        int j = i + 1;
+        if (j < task->last && a[j] < a[i]) {
+            while (j + 1 < task->last && a[j + 1] < a[j]) j++;
+            reverse(a, i, j);
+        } else {
+            while (j < task->last && a[j] >= a[j - 1]) j++;
+            j--;
+        }
+        if (task->numRuns == MAX_RUNS) {
+            task->overflow = true;
+            return NULL;
+        }
+        task->runs[task->numRuns++] = (Run){ i, j + 1 };
+        i = j + 1;
+    }
+    return NULL;
+}
+
+/* Scan the array in parallel and collect its runs in order.
+   Neighbouring runs that are already in order are coalesced.
+   Returns the number of runs, or -1 if there are too many or the
+   scan cannot be allocated. */
+int findRuns(int *array, int size, Run *runs) {
+    pthread_t workers[MAXTHREADS];
+    ScanTask *tasks = malloc(sizeof(ScanTask) * numThreads);
+    int chunk = size / numThreads;
+    int numRuns = 0;
+
+    if (!tasks) return -1;
+    for (int t = 0; t < numThreads; t++) {
+        tasks[t].first = t * chunk;
+        tasks[t].last = (t == numThreads - 1) ? size : (t + 1) * chunk;
+        tasks[t].array = array;
+        pthread_create(&workers[t], NULL, scanWorker, &tasks[t]);
+    }
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+
+    for (int t = 0; t < numThreads && numRuns >= 0; t++) {
+        if (tasks[t].overflow) {
+            numRuns = -1;
+            break;
+        }
+        for (int r = 0; r < tasks[t].numRuns; r++) {
+            Run run = tasks[t].runs[r];
+            if (numRuns > 0 && array[run.start - 1] <= array[run.start]) {
+                runs[numRuns - 1].end = run.end;
+            } else if (numRuns == MAX_RUNS) {
+                numRuns = -1;
+                break;
+            } else {
+                runs[numRuns++] = run;
+            }
+        }
+    }
+
+    free(tasks);
+    return numRuns;
+}
+
+/* ------------------------------------------------------------------ */
+/* Parallel merge                                                     */
+/* ------------------------------------------------------------------ */
+
+/* Number of elements taken from a when the first k elements of the
+   merge of a[0..m) and b[0..n) are output (ties go to a) */
+int coRank(int k, const int *a, int m, const int *b, int n) {
+    int lo = (k > n) ? k - n : 0;
+    int hi = (k < m) ? k : m;
+
+    while (1) {
+        int i = lo + (hi - lo) / 2;
+        int j = k - i;
+        if (i < m && j > 0 && b[j - 1] >= a[i]) {
+            lo = i + 1;
+        } else if (i > 0 && j < n && a[i - 1] > b[j]) {
+            hi = i - 1;
+        } else {
+            return i;
+        }
+    }
+}
+
+/* Serial merge of a[0..m) and b[0..n) into dst */
+void serialMerge(const int *a, int m, const int *b, int n, int *dst) {
+    int i = 0, j = 0, k = 0;
+    while (i < m && j < n) {
+        dst[k++] = (b[j] < a[i]) ? b[j++] : a[i++];
+    }
+    while (i < m) dst[k++] = a[i++];
+    while (j < n) dst[k++] = b[j++];
+}
+
+/* Struct for passing one slice of a merge to a thread */
+typedef struct {
+    const int *a, *b;
+    int m, n;
+    int *dst;
+    int k0, k1;     /* output slice [k0, k1) */
+} MergeTask;
+
+void *mergeWorker(void *arg) {
+    MergeTask *task = (MergeTask *)arg;
+    int i0 = coRank(task->k0, task->a, task->m, task->b, task->n);
+    int i1 = coRank(task->k1, task->a, task->m, task->b, task->n);
+    int j0 = task->k0 - i0;
+    int j1 = task->k1 - i1;
+    serialMerge(task->a + i0, i1 - i0, task->b + j0, j1 - j0, task->dst + task->k0);
+    return NULL;
+}
+
+/* Merge a[0..m) and b[0..n) into dst, splitting the output evenly */
+void parallelMerge(const int *a, int m, const int *b, int n, int *dst) {
+    pthread_t workers[MAXTHREADS];
+    MergeTask tasks[MAXTHREADS];
+    int total = m + n;
+
+    if (numThreads == 1 || total < MIN_PARALLEL_MERGE) {
+        serialMerge(a, m, b, n, dst);
+        return;
+    }
+
+    for (int t = 0; t < numThreads; t++) {
+        tasks[t] = (MergeTask){ a, b, m, n, dst,
+                                (int)((long)total * t / numThreads),
+                                (int)((long)total * (t + 1) / numThreads) };
+        pthread_create(&workers[t], NULL, mergeWorker, &tasks[t]);
+    }
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+}
+
+/* Merge the runs pairwise, ping-ponging between array and scratch.
+   Returns false, leaving array untouched, if there is no scratch. */
+bool mergeRuns(int *array, int size, Run *runs, int numRuns) {
+    int *scratch = (int *)malloc(sizeof(int) * size);
+    int *src = array;
+    int *dst = scratch;
+
+    if (!scratch) return false;
+    while (numRuns > 1) {
+        int merged = 0;
+        for (int r = 0; r < numRuns; r += 2) {
+            Run a = runs[r];
+            if (r + 1 == numRuns) {
+                memcpy(dst + a.start, src + a.start, sizeof(int) * (a.end - a.start));
+                runs[merged++] = a;
+            } else {
+                Run b = runs[r + 1];
+                parallelMerge(src + a.start, a.end - a.start,
+                              src + b.start, b.end - b.start, dst + a.start);
+                runs[merged++] = (Run){ a.start, b.end };
+            }
+        }
+        numRuns = merged;
+        int *temp = src;
+        src = dst;
+        dst = temp;
+    }
+
+    if (src != array) {
+        memcpy(array, src, sizeof(int) * size);
+    }
+    free(scratch);
+    return true;
+}
+
+/* Adaptive sort: merge the natural runs if there are few of them,
+   otherwise (or without memory for the merge) fall back to the
+   parallel quicksort */
+void adaptiveSort(int *array, int size) {
+    Run runs[MAX_RUNS];
+    int numRuns;
+
+    if (size < 2) return;
+    numRuns = findRuns(array, size, runs);
+    if (numRuns < 0 || (numRuns > 1 && !mergeRuns(array, size, runs, numRuns))) {
+        parallelQuicksort(0, size - 1, spawnDepth(numThreads), array);
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* Driver                                                             */
+/* ------------------------------------------------------------------ */
+
+void fillArray(int *array, int size, int kind) {
+    int runLength = size / 16 + 1;
+
+    for (int i = 0; i < size; i++) {
+        switch (kind) {
+        case 1:  array[i] = i; break;
+        case 2:  array[i] = size - i; break;
+        case 3:  /* alternating ascending and descending runs */
+            array[i] = ((i / runLength) % 2) ? runLength - i % runLength : i % runLength;
+            break;
+        case 4:  array[i] = i; break;
+        default: array[i] = rand() % (size * 10); break;
+        }
+    }
+    if (kind == 4) {
+        /* a handful of out-of-place elements */
+        for (int s = 0; s < 8 && size > 0; s++) {
+            swap(&array[rand() % size], &array[rand() % size]);
+        }
+    }
+}
+
+bool array_equality(int *a, int *b, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double timeDiff(struct timeval start, struct timeval end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc == 1) {
+        printf("Usage: %s <array_size> <num_threads> <input_kind>\n", argv[0]);
+    }
+
+    int arraySize = (argc > 1) ? atoi(argv[1]) : DEFAULT_ARRAY_SIZE;
+    numThreads    = (argc > 2) ? atoi(argv[2]) : 4;
+    int kind      = (argc > 3) ? atoi(argv[3]) : 0;
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > MAXTHREADS) numThreads = MAXTHREADS;
+
+    // Allocate and initialize the arrays
+    int *array    = (int *)malloc(sizeof(int) * arraySize);
+    int *copy     = (int *)malloc(sizeof(int) * arraySize);
+    int *adaptive = (int *)malloc(sizeof(int) * arraySize);
+    if (!array || !copy || !adaptive) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+
+    srand(42);
+    fillArray(array, arraySize, kind);
+    memcpy(copy, array, sizeof(int) * arraySize);
+    memcpy(adaptive, array, sizeof(int) * arraySize);
+
+    struct timeval start, end;
+
+    // Measure serial quicksort
+    gettimeofday(&start, NULL);
+    serialQuicksort(0, arraySize - 1, array);
+    gettimeofday(&end, NULL);
+    double serialTime = timeDiff(start, end);
+
+    // Measure parallel quicksort
+    gettimeofday(&start, NULL);
+    parallelQuicksort(0, arraySize - 1, spawnDepth(numThreads), copy);
+    gettimeofday(&end, NULL);
+    double parallelTime = timeDiff(start, end);
+
+    // Measure adaptive sort
+    gettimeofday(&start, NULL);
+    adaptiveSort(adaptive, arraySize);
+    gettimeofday(&end, NULL);
+    double adaptiveTime = timeDiff(start, end);
+
+    // Output results
+    printf("Array Size         : %d\n", arraySize);
+    printf("Input Kind         : %d\n", kind);
+    printf("Serial Time        : %f seconds\n", serialTime);
+    printf("Parallel Time      : %f seconds\n", parallelTime);
+    printf("Adaptive Time      : %f seconds\n", adaptiveTime);
+    printf("Array Equality?    : %s\n",
+           (array_equality(array, copy, arraySize) && array_equality(array, adaptive, arraySize)) ? "True" : "False");
+
+    free(array);
+    free(copy);
+    free(adaptive);
+    return 0;
+}
@@ -0,0 +1,203 @@
+/* binary matrix/array container read with mmap
+
+   File layout: a 64-byte header followed by the raw elements, row-major,
+   starting at dataOffset. Row r starts stride elements after row r - 1,
+   so padded rows can be stored as they are in memory. A flat array is a
+   matrix with one row.
+
+     offset  size  field
+          0     8  magic "ID1217MX"
+          8     4  endianCheck, 0x01020304 in the writer's byte order
+         12     4  dtype (BinDtype)
+         16     8  rows
+         24     8  cols
+         32     8  stride (elements, >= cols)
+         40     8  dataOffset (bytes, multiple of 64)
+         48    16  reserved, zero
+
+   Files written on a machine of the other byte order are rejected rather
+   than converted, since converting would defeat the zero-copy mapping.
+*/
+#ifndef BINMATRIX_H
+#define BINMATRIX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define BINMATRIX_MAGIC       "ID1217MX"
+#define BINMATRIX_ENDIAN      0x01020304u
+#define BINMATRIX_DATA_OFFSET 64
+#define BINMATRIX_ALIGN       64  /* dataOffset must be a multiple of this */
+
+/* Flags for binmatrixOpen */
+#define BINMATRIX_POPULATE    1  /* prefault the whole mapping (MAP_POPULATE) */
+#define BINMATRIX_SEQUENTIAL  2  /* madvise(MADV_SEQUENTIAL) */
+#define BINMATRIX_PRIVATE     4  /* writable copy-on-write mapping */
+
+typedef enum {
+    DTYPE_INT32 = 1,
+    DTYPE_INT64 = 2,
+    DTYPE_FLOAT32 = 3,
+    DTYPE_FLOAT64 = 4
+} BinDtype;
+
+typedef struct {
+    char magic[8];
+    uint32_t endianCheck;
+    uint32_t dtype;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t stride;
+    uint64_t dataOffset;
+    uint64_t reserved[2];
+} BinMatrixHeader;
+
+/* An open container: the header and a pointer to element (0, 0) */
+typedef struct {
+    BinMatrixHeader header;
+    void *data;
+    void *map;
+    size_t mapSize;
+} BinMatrix;
+
+static inline size_t binDtypeSize(uint32_t dtype) {
+    switch (dtype) {
+    case DTYPE_INT32:   return 4;
+    case DTYPE_INT64:   return 8;
+    case DTYPE_FLOAT32: return 4;
+    case DTYPE_FLOAT64: return 8;
+    default:            return 0;
+    }
+}
+
+/* Does rows x stride x dtype size, or that plus dataOffset, overflow?
+   Checked before binmatrixDataBytes so a crafted header cannot wrap it */
+static inline bool binmatrixTooLarge(const BinMatrixHeader *h) {
+    uint64_t size = binDtypeSize(h->dtype);
+    if (h->rows == 0 || h->stride == 0 || size == 0) return false;
+    if (h->rows > SIZE_MAX / h->stride || h->rows * h->stride > SIZE_MAX / size) return true;
+    return h->dataOffset > SIZE_MAX - h->rows * h->stride * size;
+}
+
+/* Bytes of element data, the last row counting only its cols */
+static inline size_t binmatrixDataBytes(const BinMatrixHeader *h) {
+    if (h->rows == 0) return 0;
+    return ((h->rows - 1) * h->stride + h->cols) * binDtypeSize(h->dtype);
+}
+
+/* Map path and validate its header. Returns 0 on success, -1 with a
+   message on stderr otherwise. */
+static inline int binmatrixOpen(const char *path, int flags, BinMatrix *m) {
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    memset(m, 0, sizeof(*m));
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    if ((size_t)st.st_size < sizeof(BinMatrixHeader) ||
+        pread(fd, &m->header, sizeof(m->header), 0) != sizeof(m->header)) {
+        fprintf(stderr, "%s: too short for a header\n", path);
+        close(fd);
+        return -1;
+    }
+
+    BinMatrixHeader *h = &m->header;
+    const char *problem = NULL;
+    if (memcmp(h->magic, BINMATRIX_MAGIC, 8) != 0) problem = "not a binmatrix file";
+    else if (h->endianCheck != BINMATRIX_ENDIAN) problem = "written with the other byte order";
+    else if (binDtypeSize(h->dtype) == 0) problem = "unknown dtype";
+    else if (h->stride < h->cols) problem = "stride smaller than cols";
+    else if (h->dataOffset < sizeof(BinMatrixHeader) || h->dataOffset % BINMATRIX_ALIGN != 0)
+        problem = "bad data offset";
+    else if (binmatrixTooLarge(h)) problem = "dimensions too large";
+    else if (h->dataOffset + binmatrixDataBytes(h) > (uint64_t)st.st_size) problem = "truncated";
+    if (problem) {
+        fprintf(stderr, "%s: %s\n", path, problem);
+        close(fd);
+        return -1;
+    }
+
+    int mapFlags = (flags & BINMATRIX_PRIVATE) ? MAP_PRIVATE : MAP_SHARED;
+    int prot = (flags & BINMATRIX_PRIVATE) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+#ifdef MAP_POPULATE
+    if (flags & BINMATRIX_POPULATE) mapFlags |= MAP_POPULATE;
+#endif
+    m->mapSize = st.st_size;
+    m->map = mmap(NULL, m->mapSize, prot, mapFlags, fd, 0);
+    close(fd);
+    if (m->map == MAP_FAILED) {
+        fprintf(stderr, "%s: mmap failed\n", path);
+        m->map = NULL;
+        return -1;
+    }
+    if (flags & BINMATRIX_SEQUENTIAL) madvise(m->map, m->mapSize, MADV_SEQUENTIAL);
+    m->data = (char *)m->map + h->dataOffset;
+    return 0;
+}
+
+/* Create path holding a rows x cols matrix with the given row stride
+   and map it writable, so results can be produced directly in the file */
+static inline int binmatrixCreate(const char *path, BinDtype dtype, uint64_t rows, uint64_t cols,
+                                  uint64_t stride, BinMatrix *m) {
+    memset(m, 0, sizeof(*m));
+    memcpy(m->header.magic, BINMATRIX_MAGIC, 8);
+    m->header.endianCheck = BINMATRIX_ENDIAN;
+    m->header.dtype = dtype;
+    m->header.rows = rows;
+    m->header.cols = cols;
+    m->header.stride = (stride > cols) ? stride : cols;
+    m->header.dataOffset = BINMATRIX_DATA_OFFSET;
+    m->mapSize = BINMATRIX_DATA_OFFSET + binmatrixDataBytes(&m->header);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, m->mapSize) < 0 ||
+        pwrite(fd, &m->header, sizeof(m->header), 0) != sizeof(m->header)) {
+        fprintf(stderr, "%s: cannot create\n", path);
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    m->map = mmap(NULL, m->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m->map == MAP_FAILED) {
+        fprintf(stderr, "%s: mmap failed\n", path);
+        m->map = NULL;
+        return -1;
+    }
+    m->data = (char *)m->map + BINMATRIX_DATA_OFFSET;
+    return 0;
+}
+
+/* Write a matrix held in memory (row r at data + r * stride elements)
+   with its rows packed */
+static inline int binmatrixWrite(const char *path, BinDtype dtype, uint64_t rows, uint64_t cols,
+                                 const void *data, uint64_t stride) {
+    BinMatrix m;
+    size_t rowBytes = cols * binDtypeSize(dtype);
+    if (binmatrixCreate(path, dtype, rows, cols, cols, &m) < 0) return -1;
+    for (uint64_t r = 0; r < rows; r++) {
+        memcpy((char *)m.data + r * rowBytes, (const char *)data + r * stride * binDtypeSize(dtype), rowBytes);
+    }
+    munmap(m.map, m.mapSize);
+    return 0;
+}
+
+static inline void binmatrixClose(BinMatrix *m) {
+    if (m->map) munmap(m->map, m->mapSize);
+    m->map = NULL;
+    m->data = NULL;
+}
+
+/* Pointer to row r of an open container */
+static inline void *binmatrixRow(const BinMatrix *m, uint64_t r) {
+    return (char *)m->data + r * m->header.stride * binDtypeSize(m->header.dtype);
+}
+
+#endif /* BINMATRIX_H */
@@ -0,0 +1,48 @@
+/* generate a random int32 matrix or array in the binmatrix format
+
+   usage under Linux:
+     gcc -O2 binmatrixGen.c -o binmatrixGen
+     ./binmatrixGen file rows cols seed maxValue stride
+
+   A flat array for the sort drivers is a matrix with one row.
+   maxValue defaults to 100 (values [0, 99], as in the matrixSum
+   programs) and stride to cols.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "binmatrix.h"
+
+int main(int argc, char *argv[]) {
+    if (argc < 4) {
+        printf("Usage: %s file rows cols seed maxValue stride\n", argv[0]);
+        return 1;
+    }
+
+    uint64_t rows = strtoull(argv[2], NULL, 10);
+    uint64_t cols = strtoull(argv[3], NULL, 10);
+    int seed = (argc > 4) ? atoi(argv[4]) : -1;
+    int maxValue = (argc > 5) ? atoi(argv[5]) : 100;
+    uint64_t stride = (argc > 6) ? strtoull(argv[6], NULL, 10) : cols;
+    if (maxValue < 1) maxValue = 1;
+
+    BinMatrix m;
+    if (binmatrixCreate(argv[1], DTYPE_INT32, rows, cols, stride, &m) < 0) {
+        return 1;
+    }
+
+    srand(seed >= 0 ? seed : time(NULL));
+    for (uint64_t i = 0; i < rows; i++) {
+        int32_t *row = (int32_t *)binmatrixRow(&m, i);
+        for (uint64_t j = 0; j < cols; j++) {
+            row[j] = rand() % maxValue;
+        }
+    }
+
+    printf("Wrote %llu x %llu int32 matrix (stride %llu) to %s\n",
+           (unsigned long long)rows, (unsigned long long)cols,
+           (unsigned long long)m.header.stride, argv[1]);
+    binmatrixClose(&m);
+    return 0;
+}
@@ -0,0 +1,474 @@
+/* external (out-of-core) sort of binary int files using pthreads
+
+   features: the input is read in chunks that fit in memory, every chunk
+             is sorted with the parallel quicksort and spilled to a run
+             file, and the runs are combined with a k-way merge driven
+             by a loser tree. Three chunk buffers rotate between a reader
+             thread, the sorting (main) thread and a writer thread, so
+             reading the next chunk, sorting the current one and writing
+             the previous run overlap.
+
+   usage under Linux:
+     gcc -O2 externalSort.c -lpthread -o externalSort
+     ./externalSort --generate <file> <count> <seed>
+     ./externalSort <input> <output> <chunk_elements> <num_threads>
+
+   Files hold raw native-endian ints. Run files go to $TMPDIR (or /tmp).
+*/
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>  // For gettimeofday()
+
+#define DEFAULT_CHUNK   (1 << 24)  // Elements per in-memory chunk
+#define MAXTHREADS      16
+#define THRESHOLD       100000     // Switch to serial sorting for small partitions
+#define NUM_BUFFERS     3          // Reading, sorting and writing in flight
+#define RUN_BUFFER      (1 << 16)  // Elements buffered per run while merging
+#define OUT_BUFFER      (1 << 18)  // Elements buffered for the merged output
+
+/* Swap helper function */
+void swap(int *a, int *b) {
+    int temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+/* Median-of-Three Pivot Selection */
+int medianOfThree(int left, int right, int *array) {
+    int mid = left + (right - left) / 2;
+    if (array[left] > array[mid]) swap(&array[left], &array[mid]);
+    if (array[left] > array[right]) swap(&array[left], &array[right]);
+    if (array[mid] > array[right]) swap(&array[mid], &array[right]);
+    return mid;
+}
+
+/* Partition function for quicksort */
+int partition(int left, int right, int *array) {
+    int pivotIndex = medianOfThree(left, right, array);
+    swap(&array[pivotIndex], &array[right]);
+    int pivot = array[right];
+    int i = left - 1;
+
+    for (int j = left; j < right; j++) {
+        if (array[j] < pivot) {
+            i++;
+            swap(&array[i], &array[j]);
+        }
+    }
+    swap(&array[i + 1], &array[right]);
+    return i + 1;
+}
+
+/* Serial Quicksort */
+void serialQuicksort(int left, int right, int *array) {
+    if (left < right) {
+        int pivotIndex = partition(left, right, array);
+        serialQuicksort(left, pivotIndex - 1, array);
+        serialQuicksort(pivotIndex + 1, right, array);
+    }
+}
+
+/* Struct for passing data to pthread */
+typedef struct {
+    int left;
+    int right;
+    int depth;
+    int *array;
+} QuickSortTask;
+
+void *parallelQuicksortWorker(void *arg);
+
+/* Parallel Quicksort; spawns threads only while depth allows */
+void parallelQuicksort(int left, int right, int depth, int *array) {
+    if (depth > 0 && (right - left) > THRESHOLD) {
+        int pivotIndex = partition(left, right, array);
+        pthread_t leftThread;
+        QuickSortTask task = { left, pivotIndex - 1, depth - 1, array };
+        pthread_create(&leftThread, NULL, parallelQuicksortWorker, &task);
+        parallelQuicksort(pivotIndex + 1, right, depth - 1, array);
+        pthread_join(leftThread, NULL);
+    } else {
+        serialQuicksort(left, right, array);
+    }
+}
+
+void *parallelQuicksortWorker(void *arg) {
+    QuickSortTask *task = (QuickSortTask *)arg;
+    parallelQuicksort(task->left, task->right, task->depth, task->array);
+    return NULL;
+}
+
+/* Number of spawn levels needed to keep numThreads busy */
+int spawnDepth(int threads) {
+    int depth = 0;
+    while ((1 << depth) < threads) depth++;
+    return depth;
+}
+
+double timeDiff(struct timeval start, struct timeval end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+/* ------------------------------------------------------------------ */
+/* Phase 1: sorted runs with overlapped read, sort and write          */
+/* ------------------------------------------------------------------ */
+
+typedef enum { BUFFER_FREE, BUFFER_FILLED, BUFFER_SORTED } BufferState;
+
+/* A chunk buffer travelling reader -> sorter -> writer -> reader */
+typedef struct {
+    int *data;
+    size_t count;       /* 0 marks the end of the input */
+    BufferState state;
+} ChunkBuffer;
+
+/* Global Variables */
+ChunkBuffer buffers[NUM_BUFFERS];
+pthread_mutex_t bufferLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t bufferChanged = PTHREAD_COND_INITIALIZER;
+FILE *input;
+size_t chunkSize;
+int numThreads;
+char **runPaths;        /* run files, in the order they were written */
+int numRuns = 0;
+bool ioError = false;
+
+void waitForState(ChunkBuffer *buffer, BufferState state) {
+    pthread_mutex_lock(&bufferLock);
+    while (buffer->state != state) {
+        pthread_cond_wait(&bufferChanged, &bufferLock);
+    }
+    pthread_mutex_unlock(&bufferLock);
+}
+
+void setState(ChunkBuffer *buffer, BufferState state) {
+    pthread_mutex_lock(&bufferLock);
+    buffer->state = state;
+    pthread_cond_broadcast(&bufferChanged);
+    pthread_mutex_unlock(&bufferLock);
+}
+
+/* Reader: fill free buffers in turn until the input is exhausted */
+void *Reader(void *arg) {
+    (void)arg;
+    for (int i = 0; ; i++) {
+        ChunkBuffer *buffer = &buffers[i % NUM_BUFFERS];
+        waitForState(buffer, BUFFER_FREE);
+        size_t count = fread(buffer->data, sizeof(int), chunkSize, input);
+        buffer->count = count;
+        setState(buffer, BUFFER_FILLED);
+        if (count == 0) return NULL;
+    }
+}
+
+/* Writer: spill sorted buffers to run files in turn */
+void *Writer(void *arg) {
+    (void)arg;
+    const char *dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+
+    for (int i = 0; ; i++) {
+        ChunkBuffer *buffer = &buffers[i % NUM_BUFFERS];
+        waitForState(buffer, BUFFER_SORTED);
+        if (buffer->count == 0) return NULL;
+
+        char *path = (char *)malloc(strlen(dir) + 32);
+        if (!path) {
+            printf("Memory allocation error!\n");
+            ioError = true;
+            setState(buffer, BUFFER_FREE);
+            continue;
+        }
+        sprintf(path, "%s/extsort-XXXXXX", dir);
+        int fd = mkstemp(path);
+        FILE *run = (fd >= 0) ? fdopen(fd, "wb") : NULL;
+        if (!run || fwrite(buffer->data, sizeof(int), buffer->count, run) != buffer->count) {
+            printf("Error writing run file %s\n", path);
+            ioError = true;
+        }
+        if (run) fclose(run);
+        runPaths[numRuns++] = path;
+        setState(buffer, BUFFER_FREE);
+    }
+}
+
+/* Sort every chunk as soon as the reader hands it over; false if the
+   buffers cannot be allocated */
+bool makeRuns(size_t inputSize) {
+    pthread_t reader, writer;
+    bool allocated;
+
+    runPaths = (char **)malloc(sizeof(char *) * (inputSize / chunkSize + 2));
+    allocated = (runPaths != NULL);
+    for (int b = 0; b < NUM_BUFFERS; b++) {
+        buffers[b].data = (int *)malloc(sizeof(int) * chunkSize);
+        buffers[b].state = BUFFER_FREE;
+        allocated = allocated && buffers[b].data;
+    }
+    if (!allocated) {
+        for (int b = 0; b < NUM_BUFFERS; b++) free(buffers[b].data);
+        return false;
+    }
+
+    pthread_create(&reader, NULL, Reader, NULL);
+    pthread_create(&writer, NULL, Writer, NULL);
+    for (int i = 0; ; i++) {
+        ChunkBuffer *buffer = &buffers[i % NUM_BUFFERS];
+        waitForState(buffer, BUFFER_FILLED);
+        /* once SORTED the buffer is the writer's, and the reader may refill
+           it, so remember the count before handing it over */
+        size_t count = buffer->count;
+        if (count > 0) {
+            parallelQuicksort(0, (int)count - 1, spawnDepth(numThreads), buffer->data);
+        }
+        setState(buffer, BUFFER_SORTED);
+        if (count == 0) break;
+    }
+    pthread_join(reader, NULL);
+    pthread_join(writer, NULL);
+
+    for (int b = 0; b < NUM_BUFFERS; b++) {
+        free(buffers[b].data);
+    }
+    return true;
+}
+
+/* ------------------------------------------------------------------ */
+/* Phase 2: k-way merge with a loser tree                             */
+/* ------------------------------------------------------------------ */
+
+/* A run being merged: its file and a window of buffered elements */
+typedef struct {
+    FILE *file;
+    int *data;
+    size_t count, pos;
+    bool exhausted;
+} RunReader;
+
+RunReader *readers;
+int *loserTree;         /* [0] holds the winner, [1..k) the losers */
+
+/* Make sure the run has a current element, refilling its window */
+void refill(RunReader *run) {
+    if (run->pos == run->count && !run->exhausted) {
+        run->count = fread(run->data, sizeof(int), RUN_BUFFER, run->file);
+        run->pos = 0;
+        run->exhausted = (run->count == 0);
+    }
+}
+
+/* Does run a's current element come before run b's? Exhausted runs
+   compare as +infinity; ties go to the earlier run. */
+bool beats(int a, int b) {
+    if (readers[a].exhausted) return false;
+    if (readers[b].exhausted) return true;
+    int x = readers[a].data[readers[a].pos];
+    int y = readers[b].data[readers[b].pos];
+    return x < y || (x == y && a < b);
+}
+
+/* Play the matches below node; store losers and return the winner */
+int buildLoserTree(int node, int k) {
+    if (node >= k) return node - k;
+    int left = buildLoserTree(2 * node, k);
+    int right = buildLoserTree(2 * node + 1, k);
+    if (beats(left, right)) {
+        loserTree[node] = right;
+        return left;
+    }
+    loserTree[node] = left;
+    return right;
+}
+
+/* Replay the matches from leaf run up to the root */
+void replay(int run, int k) {
+    int winner = run;
+    for (int node = (run + k) / 2; node >= 1; node /= 2) {
+        if (beats(loserTree[node], winner)) {
+            int temp = loserTree[node];
+            loserTree[node] = winner;
+            winner = temp;
+        }
+    }
+    loserTree[0] = winner;
+}
+
+/* Remove the run files */
+void removeRuns(void) {
+    for (int r = 0; r < numRuns; r++) {
+        unlink(runPaths[r]);
+        free(runPaths[r]);
+    }
+}
+
+/* Merge all runs into output; returns the number of elements written */
+size_t mergeRuns(FILE *output) {
+    int k = numRuns;
+    int *out = (int *)calloc(OUT_BUFFER, sizeof(int));
+    size_t outCount = 0, written = 0;
+
+    readers = (RunReader *)calloc(k > 0 ? k : 1, sizeof(RunReader));
+    loserTree = (int *)malloc(sizeof(int) * (k > 0 ? k : 1));
+    if (!out || !readers || !loserTree) {
+        printf("Memory allocation error!\n");
+        ioError = true;
+        free(out);
+        free(readers);
+        free(loserTree);
+        removeRuns();
+        return 0;
+    }
+    for (int r = 0; r < k; r++) {
+        readers[r].file = fopen(runPaths[r], "rb");
+        readers[r].data = (int *)malloc(sizeof(int) * RUN_BUFFER);
+        if (!readers[r].data) {
+            printf("Memory allocation error!\n");
+            ioError = true;
+            readers[r].exhausted = true;
+            continue;
+        }
+        if (!readers[r].file) {
+            printf("Error opening run file %s\n", runPaths[r]);
+            ioError = true;
+            readers[r].exhausted = true;
+            continue;
+        }
+        refill(&readers[r]);
+    }
+
+    if (k > 0) {
+        loserTree[0] = buildLoserTree(1, k);
+        while (!readers[loserTree[0]].exhausted) {
+            RunReader *run = &readers[loserTree[0]];
+            out[outCount++] = run->data[run->pos++];
+            if (outCount == OUT_BUFFER) {
+                written += fwrite(out, sizeof(int), outCount, output);
+                outCount = 0;
+            }
+            refill(run);
+            replay(loserTree[0], k);
+        }
+    }
+    written += fwrite(out, sizeof(int), outCount, output);
+
+    for (int r = 0; r < k; r++) {
+        if (readers[r].file) fclose(readers[r].file);
+        free(readers[r].data);
+    }
+    removeRuns();
+    free(readers);
+    free(loserTree);
+    free(out);
+    return written;
+}
+
+/* ------------------------------------------------------------------ */
+/* Driver                                                             */
+/* ------------------------------------------------------------------ */
+
+/* Write count random ints to path */
+int generate(const char *path, long count, int seed) {
+    FILE *file = fopen(path, "wb");
+    int buffer[4096];
+    if (!file) {
+        printf("Error opening %s\n", path);
+        return 1;
+    }
+    srand(seed);
+    for (long i = 0; i < count; i += 4096) {
+        int n = (count - i < 4096) ? (int)(count - i) : 4096;
+        for (int j = 0; j < n; j++) buffer[j] = rand();
+        fwrite(buffer, sizeof(int), n, file);
+    }
+    fclose(file);
+    return 0;
+}
+
+/* Stream through the output and check that it is in order */
+bool isSorted(const char *path, size_t *count) {
+    FILE *file = fopen(path, "rb");
+    int *buffer = (int *)malloc(sizeof(int) * RUN_BUFFER);
+    int previous = INT_MIN;
+    size_t n;
+    bool sorted = (file != NULL && buffer != NULL);
+
+    *count = 0;
+    while (file && buffer && (n = fread(buffer, sizeof(int), RUN_BUFFER, file)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (buffer[i] < previous) sorted = false;
+            previous = buffer[i];
+        }
+        *count += n;
+    }
+    if (file) fclose(file);
+    free(buffer);
+    return sorted;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--generate") == 0) {
+        if (argc < 4) {
+            printf("Usage: %s --generate <file> <count> <seed>\n", argv[0]);
+            return 1;
+        }
+        return generate(argv[2], atol(argv[3]), (argc > 4) ? atoi(argv[4]) : 42);
+    }
+    if (argc < 3) {
+        printf("Usage: %s <input> <output> <chunk_elements> <num_threads>\n", argv[0]);
+        printf("       %s --generate <file> <count> <seed>\n", argv[0]);
+        return 1;
+    }
+
+    chunkSize  = (argc > 3) ? (size_t)atol(argv[3]) : DEFAULT_CHUNK;
+    numThreads = (argc > 4) ? atoi(argv[4]) : 4;
+    if (chunkSize < 1) chunkSize = 1;
+    if (chunkSize > INT_MAX) chunkSize = INT_MAX;
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > MAXTHREADS) numThreads = MAXTHREADS;
+
+    input = fopen(argv[1], "rb");
+    FILE *output = fopen(argv[2], "wb");
+    if (!input || !output) {
+        printf("Error opening input or output file\n");
+        return 1;
+    }
+    fseek(input, 0, SEEK_END);
+    size_t inputSize = ftell(input) / sizeof(int);
+    rewind(input);
+
+    struct timeval start, middle, end;
+
+    gettimeofday(&start, NULL);
+    if (!makeRuns(inputSize)) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+    gettimeofday(&middle, NULL);
+    size_t written = mergeRuns(output);
+    fclose(output);
+    gettimeofday(&end, NULL);
+    fclose(input);
+
+    size_t checked;
+    bool sorted = isSorted(argv[2], &checked);
+
+    // Output results
+    printf("Elements           : %zu\n", inputSize);
+    printf("Chunk Size         : %zu\n", chunkSize);
+    printf("Runs               : %d\n", numRuns);
+    printf("Run Phase Time     : %f seconds\n", timeDiff(start, middle));
+    printf("Merge Phase Time   : %f seconds\n", timeDiff(middle, end));
+    printf("Total Time         : %f seconds\n", timeDiff(start, end));
+    printf("Output Sorted?     : %s\n",
+           (sorted && !ioError && written == inputSize && checked == inputSize) ? "True" : "False");
+
+    free(runPaths);
+    return ioError ? 1 : 0;
+}
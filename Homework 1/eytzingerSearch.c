@@ -0,0 +1,390 @@
+/* cache-friendly search layouts over a sorted array using pthreads
+
+   features: after the parallel quicksort the result is copied into an
+             Eytzinger (BFS order) array and into a B-tree-like layout
+             with 16 keys per node (one cache line). Lower-bound lookups
+             on them are compared with bsearch and a plain binary search
+             on the sorted array. Batched Eytzinger lookups walk a group
+             of queries down the tree in lockstep and prefetch the next
+             level for all of them. Node scans use SSE2 compares when
+             available.
+
+   usage under Linux:
+     gcc -O2 eytzingerSearch.c -lpthread -o eytzingerSearch
+     ./eytzingerSearch <array_size> <num_queries> <num_threads>
+*/
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/time.h>  // For gettimeofday()
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define DEFAULT_ARRAY_SIZE  1000000
+#define DEFAULT_QUERIES     4000000
+#define MAXTHREADS          16
+#define THRESHOLD           100000  // Switch to serial sorting for small partitions
+#define BATCH               16      // Queries walked down the tree together
+#define BLOCK               16      // Keys per B-tree node
+
+/* Swap helper function */
+void swap(int *a, int *b) {
+    int temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+/* Median-of-Three Pivot Selection */
+int medianOfThree(int left, int right, int *array) {
+    int mid = left + (right - left) / 2;
+    if (array[left] > array[mid]) swap(&array[left], &array[mid]);
+    if (array[left] > array[right]) swap(&array[left], &array[right]);
+    if (array[mid] > array[right]) swap(&array[mid], &array[right]);
+    return mid;
+}
+
+/* Partition function for quicksort */
+int partition(int left, int right, int *array) {
+    int pivotIndex = medianOfThree(left, right, array);
+    swap(&array[pivotIndex], &array[right]);
+    int pivot = array[right];
+    int i = left - 1;
+
+    for (int j = left; j < right; j++) {
+        if (array[j] < pivot) {
+            i++;
+            swap(&array[i], &array[j]);
+        }
+    }
+    swap(&array[i + 1], &array[right]);
+    return i + 1;
+}
+
+/* Serial Quicksort */
+void serialQuicksort(int left, int right, int *array) {
+    if (left < right) {
+        int pivotIndex = partition(left, right, array);
+        serialQuicksort(left, pivotIndex - 1, array);
+        serialQuicksort(pivotIndex + 1, right, array);
+    }
+}
+
+/* Struct for passing data to pthread */
+typedef struct {
+    int left;
+    int right;
+    int depth;
+    int *array;
+} QuickSortTask;
+
+void *parallelQuicksortWorker(void *arg);
+
+/* Parallel Quicksort; spawns threads only while depth allows */
+void parallelQuicksort(int left, int right, int depth, int *array) {
+    if (depth > 0 && (right - left) > THRESHOLD) {
+        int pivotIndex = partition(left, right, array);
+        pthread_t leftThread;
+        QuickSortTask task = { left, pivotIndex - 1, depth - 1, array };
+        pthread_create(&leftThread, NULL, parallelQuicksortWorker, &task);
+        parallelQuicksort(pivotIndex + 1, right, depth - 1, array);
+        pthread_join(leftThread, NULL);
+    } else {
+        serialQuicksort(left, right, array);
+    }
+}
+
+void *parallelQuicksortWorker(void *arg) {
+    QuickSortTask *task = (QuickSortTask *)arg;
+    parallelQuicksort(task->left, task->right, task->depth, task->array);
+    return NULL;
+}
+
+/* Number of spawn levels needed to keep numThreads busy */
+int spawnDepth(int threads) {
+    int depth = 0;
+    while ((1 << depth) < threads) depth++;
+    return depth;
+}
+
+/* ------------------------------------------------------------------ */
+/* Search layouts                                                     */
+/* ------------------------------------------------------------------ */
+
+/* Global Variables */
+int *sorted;        /* sorted array, size n */
+int n;
+int *eytzinger;     /* 1-based BFS layout, size n + 1 */
+int eytzingerHeight;
+int (*btree)[BLOCK];  /* B-tree nodes, padded with INT_MAX */
+int numBlocks;
+
+/* Fill eytzinger[k..] from sorted[i..] by an in-order walk */
+int buildEytzinger(int i, int k) {
+    if (k <= n) {
+        i = buildEytzinger(i, 2 * k);
+        eytzinger[k] = sorted[i++];
+        i = buildEytzinger(i, 2 * k + 1);
+    }
+    return i;
+}
+
+/* Child i of B-tree node k */
+static inline int btreeChild(int k, int i) {
+    return k * (BLOCK + 1) + i + 1;
+}
+
+/* Fill the B-tree nodes from sorted[i..] by an in-order walk */
+int buildBtree(int i, int k) {
+    if (k < numBlocks) {
+        for (int j = 0; j < BLOCK; j++) {
+            i = buildBtree(i, btreeChild(k, j));
+            btree[k][j] = (i < n) ? sorted[i++] : INT_MAX;
+        }
+        i = buildBtree(i, btreeChild(k, BLOCK));
+    }
+    return i;
+}
+
+/* Build both layouts from the sorted array; false if either cannot be
+   allocated */
+bool buildLayouts() {
+    eytzinger = (int *)malloc(sizeof(int) * (n + 1));
+    if (!eytzinger) return false;
+    buildEytzinger(0, 1);
+    eytzingerHeight = 0;
+    while ((1L << eytzingerHeight) <= n) eytzingerHeight++;
+
+    numBlocks = (n + BLOCK - 1) / BLOCK;
+    if (posix_memalign((void **)&btree, 64, sizeof(int) * BLOCK * (numBlocks > 0 ? numBlocks : 1))) {
+        btree = NULL;
+        return false;
+    }
+    buildBtree(0, 0);
+    return true;
+}
+
+/* All lookups return the smallest element >= x, or INT_MAX if none */
+
+int compareInts(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/* bsearch only answers membership */
+int lookupBsearch(int x) {
+    return bsearch(&x, sorted, n, sizeof(int), compareInts) ? x : INT_MAX;
+}
+
+/* Branchless binary search on the sorted array */
+int lookupBinary(int x) {
+    const int *base = sorted;
+    int len = n;
+    if (len == 0) return INT_MAX;
+    while (len > 1) {
+        int half = len / 2;
+        base = (base[half - 1] < x) ? base + half : base;
+        len -= half;
+    }
+    return (*base < x) ? INT_MAX : *base;
+}
+
+/* Eytzinger search with the descendants four levels down prefetched */
+int lookupEytzinger(int x) {
+    int k = 1;
+    while (k <= n) {
+        __builtin_prefetch(eytzinger + 16 * (long)k);
+        k = 2 * k + (eytzinger[k] < x);
+    }
+    k >>= __builtin_ffs(~k);
+    return (k == 0) ? INT_MAX : eytzinger[k];
+}
+
+/* Eytzinger search for a batch of queries walked in lockstep */
+void lookupEytzingerBatch(const int *queries, int count, int *results) {
+    int k[BATCH];
+
+    for (int base = 0; base < count; base += BATCH) {
+        int g = (count - base < BATCH) ? count - base : BATCH;
+        for (int j = 0; j < g; j++) k[j] = 1;
+        for (int level = 0; level < eytzingerHeight; level++) {
+            for (int j = 0; j < g; j++) {
+                if (k[j] <= n) {
+                    k[j] = 2 * k[j] + (eytzinger[k[j]] < queries[base + j]);
+                    __builtin_prefetch(eytzinger + k[j]);
+                }
+            }
+        }
+        for (int j = 0; j < g; j++) {
+            int r = k[j] >> __builtin_ffs(~k[j]);
+            results[base + j] = (r == 0) ? INT_MAX : eytzinger[r];
+        }
+    }
+}
+
+/* Number of keys in a node that are smaller than x */
+static inline int nodeRank(const int *node, int x) {
+#ifdef __SSE2__
+    __m128i key = _mm_set1_epi32(x);
+    __m128i c0 = _mm_cmpgt_epi32(key, _mm_load_si128((const __m128i *)node));
+    __m128i c1 = _mm_cmpgt_epi32(key, _mm_load_si128((const __m128i *)(node + 4)));
+    __m128i c2 = _mm_cmpgt_epi32(key, _mm_load_si128((const __m128i *)(node + 8)));
+    __m128i c3 = _mm_cmpgt_epi32(key, _mm_load_si128((const __m128i *)(node + 12)));
+    __m128i packed = _mm_packs_epi16(_mm_packs_epi32(c0, c1), _mm_packs_epi32(c2, c3));
+    return __builtin_popcount(_mm_movemask_epi8(packed));
+#else
+    int rank = 0;
+    for (int i = 0; i < BLOCK; i++) rank += node[i] < x;
+    return rank;
+#endif
+}
+
+/* B-tree search, one cache line per level */
+int lookupBtree(int x) {
+    int k = 0, result = INT_MAX;
+    while (k < numBlocks) {
+        int i = nodeRank(btree[k], x);
+        if (i < BLOCK) result = btree[k][i];
+        k = btreeChild(k, i);
+    }
+    return result;
+}
+
+/* ------------------------------------------------------------------ */
+/* Lookup benchmark                                                   */
+/* ------------------------------------------------------------------ */
+
+/* Struct for passing a slice of the queries to a thread */
+typedef struct {
+    int method;
+    const int *queries;
+    int *results;
+    int first, last;
+} LookupTask;
+
+void *lookupWorker(void *arg) {
+    LookupTask *task = (LookupTask *)arg;
+    for (int i = task->first; i < task->last; i++) {
+        switch (task->method) {
+        case 0: task->results[i] = lookupBsearch(task->queries[i]); break;
+        case 1: task->results[i] = lookupBinary(task->queries[i]); break;
+        case 2: task->results[i] = lookupEytzinger(task->queries[i]); break;
+        case 4: task->results[i] = lookupBtree(task->queries[i]); break;
+        }
+    }
+    if (task->method == 3) {
+        lookupEytzingerBatch(task->queries + task->first, task->last - task->first,
+                             task->results + task->first);
+    }
+    return NULL;
+}
+
+double timeDiff(struct timeval start, struct timeval end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+/* Run all queries with one method split over numThreads threads */
+double runLookups(int method, const int *queries, int *results, int count, int numThreads) {
+    pthread_t workers[MAXTHREADS];
+    LookupTask tasks[MAXTHREADS];
+    struct timeval start, end;
+
+    gettimeofday(&start, NULL);
+    for (int t = 0; t < numThreads; t++) {
+        tasks[t] = (LookupTask){ method, queries, results,
+                                 (int)((long)count * t / numThreads),
+                                 (int)((long)count * (t + 1) / numThreads) };
+        pthread_create(&workers[t], NULL, lookupWorker, &tasks[t]);
+    }
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+    gettimeofday(&end, NULL);
+    return timeDiff(start, end);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc == 1) {
+        printf("Usage: %s <array_size> <num_queries> <num_threads>\n", argv[0]);
+    }
+
+    n              = (argc > 1) ? atoi(argv[1]) : DEFAULT_ARRAY_SIZE;
+    int numQueries = (argc > 2) ? atoi(argv[2]) : DEFAULT_QUERIES;
+    int numThreads = (argc > 3) ? atoi(argv[3]) : 4;
+    if (n < 1) n = 1;
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > MAXTHREADS) numThreads = MAXTHREADS;
+
+    sorted = (int *)malloc(sizeof(int) * n);
+    int *queries = (int *)malloc(sizeof(int) * numQueries);
+    int *expected = (int *)malloc(sizeof(int) * numQueries);
+    int *results = (int *)malloc(sizeof(int) * numQueries);
+    if (!sorted || !queries || !expected || !results) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+
+    srand(42);
+    for (int i = 0; i < n; i++) {
+        sorted[i] = rand() % (n * 10);
+    }
+    for (int i = 0; i < numQueries; i++) {
+        queries[i] = rand() % (n * 10);
+    }
+
+    struct timeval start, end;
+
+    // Sort, then build the search layouts
+    gettimeofday(&start, NULL);
+    parallelQuicksort(0, n - 1, spawnDepth(numThreads), sorted);
+    gettimeofday(&end, NULL);
+    double sortTime = timeDiff(start, end);
+
+    gettimeofday(&start, NULL);
+    bool built = buildLayouts();
+    gettimeofday(&end, NULL);
+    double buildTime = timeDiff(start, end);
+    if (!built) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+
+    printf("Array Size         : %d\n", n);
+    printf("Queries            : %d\n", numQueries);
+    printf("Sort Time          : %f seconds\n", sortTime);
+    printf("Layout Build Time  : %f seconds\n", buildTime);
+
+    // The plain binary search is the reference answer
+    double refTime = runLookups(1, queries, expected, numQueries, numThreads);
+
+    const char *names[] = { "bsearch", "Binary Search", "Eytzinger", "Eytzinger Batched", "B-tree" };
+    bool correct = true;
+    for (int method = 0; method < 5; method++) {
+        double time = (method == 1) ? refTime : runLookups(method, queries, results, numQueries, numThreads);
+        for (int i = 0; i < numQueries && method != 1; i++) {
+            /* bsearch only finds exact matches */
+            int want = (method == 0 && expected[i] != queries[i]) ? INT_MAX : expected[i];
+            if (results[i] != want) {
+                correct = false;
+                break;
+            }
+        }
+        printf("%-19s: %f seconds, %.2f Mlookups/sec\n", names[method], time,
+               numQueries / time / 1e6);
+    }
+    printf("Results Agree?     : %s\n", correct ? "True" : "False");
+
+    free(sorted);
+    free(queries);
+    free(expected);
+    free(results);
+    free(eytzinger);
+    free(btree);
+    return 0;
+}
@@ -0,0 +1,160 @@
+/* fast text and binary output of int arrays
+
+   array_write formats "[ a, b, c ]\n" (the array_print layout) without
+   printf. The array is cut into blocks of PRINT_BLOCK elements; threads
+   take blocks round-robin, format them with a table-driven itoa into a
+   private buffer, and write the buffers with single write() calls in
+   block order, handing a turn counter from block to block. Formatting of
+   later blocks overlaps the writing of earlier ones.
+
+   array_dump writes the array as a one-row int32 binmatrix file.
+*/
+#ifndef FASTPRINT_H
+#define FASTPRINT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "binmatrix.h"
+
+#define PRINT_MAXTHREADS 16
+#define PRINT_BLOCK      65536  /* elements formatted per write() */
+#define PRINT_INT_CHARS  13     /* longest element: ", -2147483648" */
+
+static const char printDigitPairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/* Write the decimal form of value at out; returns the end of the digits */
+static inline char *formatInt(char *out, int value) {
+    char digits[12];
+    char *p = digits + sizeof(digits);
+    unsigned int v = (value < 0) ? 0u - (unsigned int)value : (unsigned int)value;
+
+    while (v >= 100) {
+        unsigned int pair = (v % 100) * 2;
+        v /= 100;
+        *--p = printDigitPairs[pair + 1];
+        *--p = printDigitPairs[pair];
+    }
+    if (v >= 10) {
+        *--p = printDigitPairs[v * 2 + 1];
+        *--p = printDigitPairs[v * 2];
+    } else {
+        *--p = (char)('0' + v);
+    }
+    if (value < 0) *--p = '-';
+
+    size_t length = digits + sizeof(digits) - p;
+    memcpy(out, p, length);
+    return out + length;
+}
+
+/* write() until everything is out; returns 0 or -1 */
+static inline int writeFully(int fd, const char *buffer, size_t n) {
+    while (n > 0) {
+        ssize_t done = write(fd, buffer, n);
+        if (done <= 0) return -1;
+        buffer += done;
+        n -= done;
+    }
+    return 0;
+}
+
+/* State shared by the output threads */
+typedef struct {
+    const int *array;
+    size_t size;
+    int fd;
+    int threads;
+    size_t turn;             /* block whose buffer may be written next */
+    int error;
+    pthread_mutex_t lock;
+    pthread_cond_t turnChanged;
+} PrintJob;
+
+typedef struct {
+    PrintJob *job;
+    int id;
+} PrintWorkerArg;
+
+static inline void *printWorker(void *arg) {
+    PrintJob *job = ((PrintWorkerArg *)arg)->job;
+    int id = ((PrintWorkerArg *)arg)->id;
+    char *buffer = (char *)malloc(PRINT_BLOCK * PRINT_INT_CHARS);
+
+    for (size_t block = id; block * PRINT_BLOCK < job->size; block += job->threads) {
+        size_t first = block * PRINT_BLOCK;
+        size_t last = (first + PRINT_BLOCK < job->size) ? first + PRINT_BLOCK : job->size;
+        char *p = buffer;
+
+        for (size_t i = first; i < last; i++) {
+            if (i == 0) {
+                *p++ = ' ';
+            } else {
+                *p++ = ',';
+                *p++ = ' ';
+            }
+            p = formatInt(p, job->array[i]);
+        }
+
+        /* wait for the previous block to be written, then write this one */
+        pthread_mutex_lock(&job->lock);
+        while (job->turn != block) pthread_cond_wait(&job->turnChanged, &job->lock);
+        pthread_mutex_unlock(&job->lock);
+
+        if (!job->error && writeFully(job->fd, buffer, p - buffer) < 0) job->error = 1;
+
+        pthread_mutex_lock(&job->lock);
+        job->turn++;
+        pthread_cond_broadcast(&job->turnChanged);
+        pthread_mutex_unlock(&job->lock);
+    }
+
+    free(buffer);
+    return NULL;
+}
+
+/* Print array as "[ a, b, c ]\n" to fd using up to threads threads.
+   Returns 0 or -1 on a write error. */
+static inline int array_write(int fd, const int *array, size_t size, int threads) {
+    pthread_t workers[PRINT_MAXTHREADS];
+    PrintWorkerArg args[PRINT_MAXTHREADS];
+    PrintJob job = { array, size, fd, threads, 0, 0,
+                     PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+    size_t blocks = (size + PRINT_BLOCK - 1) / PRINT_BLOCK;
+
+    if (job.threads > PRINT_MAXTHREADS) job.threads = PRINT_MAXTHREADS;
+    if ((size_t)job.threads > blocks) job.threads = (int)blocks;
+    if (job.threads < 1) job.threads = 1;
+
+    /* anything already buffered by stdio must come first */
+    fflush(stdout);
+    if (writeFully(fd, "[", 1) < 0) return -1;
+
+    if (job.threads == 1) {
+        args[0] = (PrintWorkerArg){ &job, 0 };
+        printWorker(&args[0]);
+    } else {
+        for (int t = 0; t < job.threads; t++) {
+            args[t] = (PrintWorkerArg){ &job, t };
+            pthread_create(&workers[t], NULL, printWorker, &args[t]);
+        }
+        for (int t = 0; t < job.threads; t++) {
+            pthread_join(workers[t], NULL);
+        }
+    }
+
+    if (job.error || writeFully(fd, " ]\n", 3) < 0) return -1;
+    return 0;
+}
+
+/* Dump array to path as a one-row int32 binmatrix file; returns 0 or -1 */
+static inline int array_dump(const char *path, const int *array, size_t size) {
+    return binmatrixWrite(path, DTYPE_INT32, 1, size, array, size);
+}
+
+#endif /* FASTPRINT_H */
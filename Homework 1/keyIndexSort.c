@@ -0,0 +1,379 @@
+/* key-index sorting of wide matrix records using pthreads
+
+   features: instead of swapping whole records, the (key, index) pairs
+             are extracted into a compact array in parallel, that array
+             is sorted with the parallel quicksort, and the result is
+             either returned as a permutation or applied to the records
+             in a single parallel gather pass. Using the index as a
+             tie-breaker also makes the result stable.
+             The direct sort of the records is kept for comparison.
+
+   usage under Linux:
+     gcc -O2 keyIndexSort.c -lpthread -o keyIndexSort
+     ./keyIndexSort size numThreads seed
+
+   compile with -DINDEX64 to use 64-bit indices and with
+   -DPAYLOAD_BYTES=n to change the record width.
+*/
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/time.h>  // For gettimeofday()
+
+#define MAXSIZE     4000    /* Maximum matrix size */
+#define MAXTHREADS  16      /* Maximum number of threads */
+#define THRESHOLD   100000  /* Switch to serial sorting for small partitions */
+#ifndef PAYLOAD_BYTES
+#define PAYLOAD_BYTES 52    /* Extra bytes carried by each record */
+#endif
+
+#ifdef INDEX64
+typedef uint64_t IndexType;
+#else
+typedef uint32_t IndexType;
+#endif
+
+/* Struct to store a matrix element's value and position */
+typedef struct {
+    int row;
+    int col;
+    int value;
+} MatrixElement;
+
+/* A wide record: the element plus whatever else travels with the row */
+typedef struct {
+    MatrixElement element;
+#if PAYLOAD_BYTES > 0
+    char payload[PAYLOAD_BYTES];
+#endif
+} MatrixRecord;
+
+/* Compact sort entry: the key and where its record lives */
+typedef struct {
+    int key;
+    IndexType index;
+} KeyIndex;
+
+int numThreads;
+
+/* Number of spawn levels needed to keep numThreads busy */
+int spawnDepth(int threads) {
+    int depth = 0;
+    while ((1 << depth) < threads) depth++;
+    return depth;
+}
+
+/* ------------------------------------------------------------------ */
+/* Quicksort on key/index pairs                                       */
+/* ------------------------------------------------------------------ */
+
+/* Order by key, then by original position */
+#define KI_LESS(a, b) ((a).key < (b).key || ((a).key == (b).key && (a).index < (b).index))
+
+/* Swap helper function */
+void swapKI(KeyIndex *a, KeyIndex *b) {
+    KeyIndex temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+/* Median-of-Three Pivot Selection */
+int medianOfThreeKI(int left, int right, KeyIndex *array) {
+    int mid = left + (right - left) / 2;
+    if (KI_LESS(array[mid], array[left])) swapKI(&array[left], &array[mid]);
+    if (KI_LESS(array[right], array[left])) swapKI(&array[left], &array[right]);
+    if (KI_LESS(array[right], array[mid])) swapKI(&array[mid], &array[right]);
+    return mid;
+}
+
+/* Partition function for quicksort */
+int partitionKI(int left, int right, KeyIndex *array) {
+    int pivotIndex = medianOfThreeKI(left, right, array);
+    swapKI(&array[pivotIndex], &array[right]);
+    KeyIndex pivot = array[right];
+    int i = left - 1;
+
+    for (int j = left; j < right; j++) {
+        if (KI_LESS(array[j], pivot)) {
+            i++;
+            swapKI(&array[i], &array[j]);
+        }
+    }
+    swapKI(&array[i + 1], &array[right]);
+    return i + 1;
+}
+
+/* Serial Quicksort */
+void serialQuicksortKI(int left, int right, KeyIndex *array) {
+    if (left < right) {
+        int pivotIndex = partitionKI(left, right, array);
+        serialQuicksortKI(left, pivotIndex - 1, array);
+        serialQuicksortKI(pivotIndex + 1, right, array);
+    }
+}
+
+/* Struct for passing data to pthread */
+typedef struct {
+    int left;
+    int right;
+    int depth;
+    KeyIndex *array;
+} KeyIndexTask;
+
+void *parallelQuicksortKIWorker(void *arg);
+
+/* Parallel Quicksort; spawns threads only while depth allows */
+void parallelQuicksortKI(int left, int right, int depth, KeyIndex *array) {
+    if (depth > 0 && (right - left) > THRESHOLD) {
+        int pivotIndex = partitionKI(left, right, array);
+        pthread_t leftThread;
+        KeyIndexTask task = { left, pivotIndex - 1, depth - 1, array };
+        pthread_create(&leftThread, NULL, parallelQuicksortKIWorker, &task);
+        parallelQuicksortKI(pivotIndex + 1, right, depth - 1, array);
+        pthread_join(leftThread, NULL);
+    } else {
+        serialQuicksortKI(left, right, array);
+    }
+}
+
+void *parallelQuicksortKIWorker(void *arg) {
+    KeyIndexTask *task = (KeyIndexTask *)arg;
+    parallelQuicksortKI(task->left, task->right, task->depth, task->array);
+    return NULL;
+}
+
+/* ------------------------------------------------------------------ */
+/* Quicksort on whole records (for comparison)                        */
+/* ------------------------------------------------------------------ */
+
+/* Swap helper function */
+void swapRecord(MatrixRecord *a, MatrixRecord *b) {
+    MatrixRecord temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+/* Median-of-Three Pivot Selection */
+int medianOfThreeRecord(int left, int right, MatrixRecord *array) {
+    int mid = left + (right - left) / 2;
+    if (array[left].element.value > array[mid].element.value) swapRecord(&array[left], &array[mid]);
+    if (array[left].element.value > array[right].element.value) swapRecord(&array[left], &array[right]);
+    if (array[mid].element.value > array[right].element.value) swapRecord(&array[mid], &array[right]);
+    return mid;
+}
+
+/* Partition function for quicksort */
+int partitionRecord(int left, int right, MatrixRecord *array) {
+    int pivotIndex = medianOfThreeRecord(left, right, array);
+    swapRecord(&array[pivotIndex], &array[right]);
+    int pivot = array[right].element.value;
+    int i = left - 1;
+
+    for (int j = left; j < right; j++) {
+        if (array[j].element.value < pivot) {
+            i++;
+            swapRecord(&array[i], &array[j]);
+        }
+    }
+    swapRecord(&array[i + 1], &array[right]);
+    return i + 1;
+}
+
+/* Serial Quicksort */
+void serialQuicksortRecord(int left, int right, MatrixRecord *array) {
+    if (left < right) {
+        int pivotIndex = partitionRecord(left, right, array);
+        serialQuicksortRecord(left, pivotIndex - 1, array);
+        serialQuicksortRecord(pivotIndex + 1, right, array);
+    }
+}
+
+/* Struct for passing data to pthread */
+typedef struct {
+    int left;
+    int right;
+    int depth;
+    MatrixRecord *array;
+} RecordTask;
+
+void *parallelQuicksortRecordWorker(void *arg);
+
+/* Parallel Quicksort; spawns threads only while depth allows */
+void parallelQuicksortRecord(int left, int right, int depth, MatrixRecord *array) {
+    if (depth > 0 && (right - left) > THRESHOLD) {
+        int pivotIndex = partitionRecord(left, right, array);
+        pthread_t leftThread;
+        RecordTask task = { left, pivotIndex - 1, depth - 1, array };
+        pthread_create(&leftThread, NULL, parallelQuicksortRecordWorker, &task);
+        parallelQuicksortRecord(pivotIndex + 1, right, depth - 1, array);
+        pthread_join(leftThread, NULL);
+    } else {
+        serialQuicksortRecord(left, right, array);
+    }
+}
+
+void *parallelQuicksortRecordWorker(void *arg) {
+    RecordTask *task = (RecordTask *)arg;
+    parallelQuicksortRecord(task->left, task->right, task->depth, task->array);
+    return NULL;
+}
+
+/* ------------------------------------------------------------------ */
+/* Extraction and gather                                              */
+/* ------------------------------------------------------------------ */
+
+/* Struct for passing one slice of a parallel pass to a thread */
+typedef struct {
+    int first, last;            /* slice [first, last) */
+    const MatrixRecord *records;
+    KeyIndex *pairs;
+    MatrixRecord *out;
+} PassTask;
+
+/* Copy the key and position of every record in the slice */
+void *extractWorker(void *arg) {
+    PassTask *task = (PassTask *)arg;
+    for (int i = task->first; i < task->last; i++) {
+        task->pairs[i].key = task->records[i].element.value;
+        task->pairs[i].index = (IndexType)i;
+    }
+    return NULL;
+}
+
+/* Pull every record of the slice from its sorted position */
+void *gatherWorker(void *arg) {
+    PassTask *task = (PassTask *)arg;
+    for (int i = task->first; i < task->last; i++) {
+        task->out[i] = task->records[task->pairs[i].index];
+    }
+    return NULL;
+}
+
+/* Run fn over [0, size) split evenly between numThreads threads */
+void parallelPass(void *(*fn)(void *), int size, const MatrixRecord *records,
+                  KeyIndex *pairs, MatrixRecord *out) {
+    pthread_t workers[MAXTHREADS];
+    PassTask tasks[MAXTHREADS];
+
+    for (int t = 0; t < numThreads; t++) {
+        tasks[t] = (PassTask){ (int)((long)size * t / numThreads),
+                               (int)((long)size * (t + 1) / numThreads),
+                               records, pairs, out };
+        pthread_create(&workers[t], NULL, fn, &tasks[t]);
+    }
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+}
+
+/* Sort the records by value without moving them; on return
+   pairs[i].index is the position of the i-th smallest record */
+void sortPermutation(const MatrixRecord *records, int size, KeyIndex *pairs) {
+    parallelPass(extractWorker, size, records, pairs, NULL);
+    parallelQuicksortKI(0, size - 1, spawnDepth(numThreads), pairs);
+}
+
+/* Apply a permutation from sortPermutation: out[i] = records[pairs[i].index] */
+void applyPermutation(const MatrixRecord *records, int size, const KeyIndex *pairs,
+                      MatrixRecord *out) {
+    parallelPass(gatherWorker, size, records, (KeyIndex *)pairs, out);
+}
+
+/* ------------------------------------------------------------------ */
+/* Driver                                                             */
+/* ------------------------------------------------------------------ */
+
+double timeDiff(struct timeval start, struct timeval end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+/* Sorted by value and stable with respect to row-major position */
+bool isStablySorted(const MatrixRecord *records, int size, int cols) {
+    for (int i = 1; i < size; i++) {
+        const MatrixElement *a = &records[i - 1].element;
+        const MatrixElement *b = &records[i].element;
+        if (a->value > b->value) return false;
+        if (a->value == b->value && a->row * cols + a->col > b->row * cols + b->col) return false;
+    }
+    return true;
+}
+
+bool valuesMatch(const MatrixRecord *a, const MatrixRecord *b, int size) {
+    for (int i = 0; i < size; i++) {
+        if (a[i].element.value != b[i].element.value) return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    int size = (argc > 1) ? atoi(argv[1]) : 2000;
+    numThreads = (argc > 2) ? atoi(argv[2]) : 4;
+    int seed = (argc > 3) ? atoi(argv[3]) : -1; // Default to -1 for no specific seed
+    if (size > MAXSIZE) size = MAXSIZE;
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > MAXTHREADS) numThreads = MAXTHREADS;
+    int count = size * size;
+
+    MatrixRecord *records = (MatrixRecord *)malloc(sizeof(MatrixRecord) * count);
+    MatrixRecord *direct  = (MatrixRecord *)malloc(sizeof(MatrixRecord) * count);
+    MatrixRecord *sorted  = (MatrixRecord *)malloc(sizeof(MatrixRecord) * count);
+    KeyIndex *pairs       = (KeyIndex *)malloc(sizeof(KeyIndex) * count);
+    if (!records || !direct || !sorted || !pairs) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+
+    /* One record per matrix element; a wide value range keeps the Lomuto
+       partition of the direct sort away from its many-duplicates worst case */
+    srand(seed >= 0 ? seed : time(NULL));
+    memset(records, 0, sizeof(MatrixRecord) * count);
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            records[i * size + j].element = (MatrixElement){ .row = i, .col = j, .value = rand() % (count * 10) };
+        }
+    }
+    memcpy(direct, records, sizeof(MatrixRecord) * count);
+
+    struct timeval start, end;
+
+    // Measure sorting the records directly
+    gettimeofday(&start, NULL);
+    parallelQuicksortRecord(0, count - 1, spawnDepth(numThreads), direct);
+    gettimeofday(&end, NULL);
+    double directTime = timeDiff(start, end);
+
+    // Measure extracting and sorting the key/index pairs
+    gettimeofday(&start, NULL);
+    sortPermutation(records, count, pairs);
+    gettimeofday(&end, NULL);
+    double permutationTime = timeDiff(start, end);
+
+    // Measure applying the permutation
+    gettimeofday(&start, NULL);
+    applyPermutation(records, count, pairs, sorted);
+    gettimeofday(&end, NULL);
+    double gatherTime = timeDiff(start, end);
+
+    // Output results
+    printf("Records            : %d (%zu bytes each, %zu-bit index)\n",
+           count, sizeof(MatrixRecord), sizeof(IndexType) * 8);
+    printf("Direct Sort Time   : %f seconds\n", directTime);
+    printf("Permutation Time   : %f seconds\n", permutationTime);
+    printf("Gather Time        : %f seconds\n", gatherTime);
+    printf("Key-Index Time     : %f seconds\n", permutationTime + gatherTime);
+    printf("Stable?            : %s\n", isStablySorted(sorted, count, size) ? "True" : "False");
+    printf("Array Equality?    : %s\n", valuesMatch(direct, sorted, count) ? "True" : "False");
+
+    free(records);
+    free(direct);
+    free(sorted);
+    free(pairs);
+    return 0;
+}
@@ -0,0 +1,366 @@
+/* incremental matrix summation under updates using pthreads
+
+   features: the matrix is cut into blocks of BLOCK cells along each row,
+             and a segment tree keeps a summary (sum, max and min with
+             positions) of every block and of every run of blocks above
+             it. The leaves are in row-major order, so a left child is
+             always the earlier half and ties keep the left value, the
+             same rule as the strict comparisons in matrixSum.taskB.c.
+
+             A point update rescans one block and redoes the log(n)
+             summaries above it; a row update redoes the row's blocks
+             and the few tree nodes above that contiguous run. Updates
+             are serialized by a writer lock. After each one the root is
+             published through a seqlock, so readers copy a consistent
+             snapshot without ever taking a lock or holding up a writer;
+             a reader that overlaps a publish simply retries.
+
+             The tree is built in parallel once; the driver then runs
+             reader threads against a stream of random updates and
+             checks the final root against a full rescan.
+
+   usage under Linux:
+     gcc -O2 matrixSum.incremental.c -lpthread
+     a.out size numWorkers seed numUpdates numReaders
+*/
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <limits.h>
+
+#define MAXSIZE    10000   /* Maximum matrix size */
+#define MAXWORKERS 10      /* Maximum number of workers and of readers */
+#define BLOCK      256     /* Cells per leaf block */
+#define UPDATES    1000000 /* Default number of updates */
+#define ROW_EVERY  1000    /* Every ROW_EVERY-th update replaces a whole row */
+
+/* Struct to store a matrix element's value and position */
+typedef struct {
+    int row;
+    int col;
+    int value;
+} MatrixElement;
+
+/* Summary of a block or of a run of blocks */
+typedef struct {
+    long long sum;
+    MatrixElement max;
+    MatrixElement min;
+} Summary;
+
+/* What a reader gets */
+typedef struct {
+    Summary root;
+    long long check;       /* sum ^ max ^ min, to catch torn copies */
+    unsigned long version; /* updates applied */
+} SnapshotData;
+
+#define SNAPSHOT_WORDS ((sizeof(SnapshotData) + 7) / 8)
+
+/* Published root: even sequence means stable. The data is kept in
+   atomic words so that a reader racing a publish is well defined. */
+typedef struct {
+    atomic_uint sequence;
+    atomic_llong words[SNAPSHOT_WORDS];
+} Snapshot;
+
+/* Global Variables */
+int size, numWorkers;              /* Matrix size, number of workers */
+int matrix[MAXSIZE][MAXSIZE];      /* Matrix */
+int blocksPerRow, numBlocks;       /* Leaves */
+int leafBase;                      /* First leaf index; a power of two */
+Summary *tree;                     /* tree[1] is the root, tree[leafBase + k] block k */
+pthread_mutex_t writerLock = PTHREAD_MUTEX_INITIALIZER;
+unsigned long updatesApplied = 0;
+Snapshot published;
+atomic_bool stopReaders;
+
+/* Function Prototypes */
+double read_timer();
+void initializeMatrix(int seed);
+void *BuildWorker(void *);
+void *Reader(void *);
+
+static const Summary emptySummary = { 0, { .value = INT_MIN }, { .value = INT_MAX } };
+
+/* Combine two summaries, a covering cells before b */
+static inline Summary combine(Summary a, Summary b) {
+    Summary s;
+    s.sum = a.sum + b.sum;
+    s.max = (b.max.value > a.max.value) ? b.max : a.max;
+    s.min = (b.min.value < a.min.value) ? b.min : a.min;
+    return s;
+}
+
+/* Rescan block k */
+static Summary scanBlock(int k) {
+    int row = k / blocksPerRow;
+    int first = (k % blocksPerRow) * BLOCK;
+    int last = (first + BLOCK < size) ? first + BLOCK : size;
+    Summary s = emptySummary;
+    for (int j = first; j < last; j++) {
+        int v = matrix[row][j];
+        s.sum += v;
+        if (v > s.max.value) s.max = (MatrixElement){ .row = row, .col = j, .value = v };
+        if (v < s.min.value) s.min = (MatrixElement){ .row = row, .col = j, .value = v };
+    }
+    return s;
+}
+
+/* Refresh leaves [k0, k1] and every node above them */
+static void refreshBlocks(int k0, int k1) {
+    for (int k = k0; k <= k1; k++) {
+        tree[leafBase + k] = scanBlock(k);
+    }
+    for (int lo = (leafBase + k0) / 2, hi = (leafBase + k1) / 2; lo >= 1; lo /= 2, hi /= 2) {
+        for (int n = lo; n <= hi; n++) {
+            tree[n] = combine(tree[2 * n], tree[2 * n + 1]);
+        }
+    }
+}
+
+static long long checkOf(const Summary *s) {
+    unsigned long long max = (unsigned long long)(unsigned)s->max.value << 32 | (unsigned)s->max.row;
+    unsigned long long min = (unsigned long long)(unsigned)s->min.value << 32 | (unsigned)s->min.col;
+    return s->sum ^ (long long)(max ^ min);
+}
+
+/* Publish the root; called with writerLock held */
+static void publish() {
+    long long words[SNAPSHOT_WORDS] = { 0 };
+    SnapshotData data = { tree[1], checkOf(&tree[1]), updatesApplied };
+    memcpy(words, &data, sizeof(data));
+
+    unsigned sequence = atomic_load_explicit(&published.sequence, memory_order_relaxed);
+    atomic_store_explicit(&published.sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    for (size_t w = 0; w < SNAPSHOT_WORDS; w++) {
+        atomic_store_explicit(&published.words[w], words[w], memory_order_relaxed);
+    }
+    atomic_store_explicit(&published.sequence, sequence + 2, memory_order_release);
+}
+
+/* Set matrix[i][j] = value */
+void updatePoint(int i, int j, int value) {
+    pthread_mutex_lock(&writerLock);
+    matrix[i][j] = value;
+    int k = i * blocksPerRow + j / BLOCK;
+    refreshBlocks(k, k);
+    updatesApplied++;
+    publish();
+    pthread_mutex_unlock(&writerLock);
+}
+
+/* Replace row i with values[0..size) */
+void updateRow(int i, const int *values) {
+    pthread_mutex_lock(&writerLock);
+    memcpy(matrix[i], values, sizeof(int) * size);
+    refreshBlocks(i * blocksPerRow, (i + 1) * blocksPerRow - 1);
+    updatesApplied++;
+    publish();
+    pthread_mutex_unlock(&writerLock);
+}
+
+/* Copy a consistent snapshot; never blocks. Returns the retries it took. */
+int readSnapshot(SnapshotData *data) {
+    long long words[SNAPSHOT_WORDS];
+    int retries = 0;
+    for (;;) {
+        unsigned before = atomic_load_explicit(&published.sequence, memory_order_acquire);
+        if (!(before & 1)) {
+            for (size_t w = 0; w < SNAPSHOT_WORDS; w++) {
+                words[w] = atomic_load_explicit(&published.words[w], memory_order_relaxed);
+            }
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&published.sequence, memory_order_relaxed) == before) {
+                memcpy(data, words, sizeof(SnapshotData));
+                return retries;
+            }
+        }
+        retries++;
+    }
+}
+
+/* Struct for reader statistics */
+typedef struct {
+    long reads;
+    long retries;
+    long torn;       /* snapshots whose check did not match */
+    long backwards;  /* snapshots older than one already seen */
+} ReaderStats;
+
+/* Reader: take snapshots until told to stop */
+void *Reader(void *arg) {
+    ReaderStats *stats = (ReaderStats *)arg;
+    unsigned long last = 0;
+    while (!atomic_load_explicit(&stopReaders, memory_order_relaxed)) {
+        SnapshotData data;
+        stats->retries += readSnapshot(&data);
+        if (data.check != checkOf(&data.root)) stats->torn++;
+        if (data.version < last) stats->backwards++;
+        last = data.version;
+        stats->reads++;
+    }
+    return NULL;
+}
+
+/* Main Function */
+int main(int argc, char *argv[]) {
+    pthread_t workers[MAXWORKERS], readers[MAXWORKERS];
+    ReaderStats readerStats[MAXWORKERS];
+    pthread_attr_t attr;
+    long t;
+
+    /* Read command-line arguments */
+    size = (argc > 1) ? atoi(argv[1]) : MAXSIZE;
+    numWorkers = (argc > 2) ? atoi(argv[2]) : MAXWORKERS;
+    int seed = (argc > 3) ? atoi(argv[3]) : -1; // Default to -1 for no specific seed
+    long numUpdates = (argc > 4) ? atol(argv[4]) : UPDATES;
+    int numReaders = (argc > 5) ? atoi(argv[5]) : 2;
+    if (size > MAXSIZE) size = MAXSIZE;
+    if (size < 1) size = 1;
+    if (numWorkers > MAXWORKERS) numWorkers = MAXWORKERS;
+    if (numWorkers < 1) numWorkers = 1;
+    if (numReaders > MAXWORKERS) numReaders = MAXWORKERS;
+    if (numReaders < 0) numReaders = 0;
+
+    /* Initialize matrix and tree */
+    initializeMatrix(seed);
+    blocksPerRow = (size + BLOCK - 1) / BLOCK;
+    numBlocks = size * blocksPerRow;
+    for (leafBase = 1; leafBase < numBlocks; leafBase *= 2);
+    tree = (Summary *)malloc(sizeof(Summary) * 2 * leafBase);
+    int *newRow = (int *)malloc(sizeof(int) * size);
+    if (!tree || !newRow) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+    for (int k = numBlocks; k < leafBase; k++) tree[leafBase + k] = emptySummary;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setscope(&attr, PTHREAD_SCOPE_SYSTEM);
+
+    /* Build: leaves in parallel, then the levels above */
+    double start_time = read_timer();
+    for (t = 0; t < numWorkers; t++) {
+        pthread_create(&workers[t], &attr, BuildWorker, (void *)t);
+    }
+    for (t = 0; t < numWorkers; t++) {
+        pthread_join(workers[t], NULL);
+    }
+    for (int n = leafBase - 1; n >= 1; n--) {
+        tree[n] = combine(tree[2 * n], tree[2 * n + 1]);
+    }
+    publish();
+    double build_time = read_timer();
+
+    /* Updates against concurrent readers */
+    atomic_store(&stopReaders, false);
+    for (t = 0; t < numReaders; t++) {
+        readerStats[t] = (ReaderStats){ 0, 0, 0, 0 };
+        pthread_create(&readers[t], &attr, Reader, &readerStats[t]);
+    }
+    double update_start = read_timer();
+    for (long u = 0; u < numUpdates; u++) {
+        if (u % ROW_EVERY == ROW_EVERY - 1) {
+            for (int j = 0; j < size; j++) newRow[j] = rand() % 200 - 50;
+            updateRow(rand() % size, newRow);
+        } else {
+            updatePoint(rand() % size, rand() % size, rand() % 200 - 50); /* [-50, 149] */
+        }
+    }
+    double update_end = read_timer();
+    atomic_store(&stopReaders, true);
+    long reads = 0, retries = 0, torn = 0, backwards = 0;
+    for (t = 0; t < numReaders; t++) {
+        pthread_join(readers[t], NULL);
+        reads += readerStats[t].reads;
+        retries += readerStats[t].retries;
+        torn += readerStats[t].torn;
+        backwards += readerStats[t].backwards;
+    }
+
+    /* Full rescan, as every read would need without the tree */
+    double scan_start = read_timer();
+    Summary full = emptySummary;
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            int v = matrix[i][j];
+            full.sum += v;
+            if (v > full.max.value) full.max = (MatrixElement){ .row = i, .col = j, .value = v };
+            if (v < full.min.value) full.min = (MatrixElement){ .row = i, .col = j, .value = v };
+        }
+    }
+    double scan_end = read_timer();
+
+    SnapshotData data;
+    readSnapshot(&data);
+    Summary root = data.root;
+    bool agree = root.sum == full.sum && memcmp(&root.max, &full.max, sizeof(MatrixElement)) == 0 &&
+                 memcmp(&root.min, &full.min, sizeof(MatrixElement)) == 0;
+
+    /* Print results */
+    printf("The total sum is: %lld\n", root.sum);
+    printf("The maximum value is %d at position (%d, %d)\n", root.max.value, root.max.row, root.max.col);
+    printf("The minimum value is %d at position (%d, %d)\n", root.min.value, root.min.row, root.min.col);
+    printf("Build time: %g sec (%d blocks of %d)\n", build_time - start_time, numBlocks, BLOCK);
+    printf("Update time: %g sec for %ld updates (%.2f us each)\n", update_end - update_start, numUpdates,
+           numUpdates ? 1e6 * (update_end - update_start) / numUpdates : 0.0);
+    printf("Full rescan time: %g sec\n", scan_end - scan_start);
+    printf("Snapshots read: %ld by %d readers (%ld retries, %ld torn, %ld out of order)\n",
+           reads, numReaders, retries, torn, backwards);
+    printf("Results agree? %s\n", agree && torn == 0 && backwards == 0 ? "True" : "False");
+
+    free(tree);
+    free(newRow);
+    return 0;
+}
+
+/* Build Worker: summarize my share of the blocks */
+void *BuildWorker(void *arg) {
+    long id = (long)arg;
+    int first = (long long)numBlocks * id / numWorkers;
+    int last = (long long)numBlocks * (id + 1) / numWorkers;
+    for (int k = first; k < last; k++) {
+        tree[leafBase + k] = scanBlock(k);
+    }
+    return NULL;
+}
+
+/* Timer Function */
+double read_timer() {
+    static struct timeval start;
+    static int initialized = 0;
+    struct timeval end;
+
+    if (!initialized) {
+        gettimeofday(&start, NULL);
+        initialized = 1;
+    }
+
+    gettimeofday(&end, NULL);
+    return (end.tv_sec - start.tv_sec) + 1.0e-6 * (end.tv_usec - start.tv_usec);
+}
+
+/* Initialize Matrix */
+void initializeMatrix(int seed) {
+    if (seed >= 0) {
+        srand(seed); // Use the provided seed for reproducibility
+    } else {
+        srand(time(NULL)); // Use the current time for randomness
+    }
+
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            matrix[i][j] = rand() % 100; /* Random values [0, 99] */
+        }
+    }
+}
@@ -0,0 +1,169 @@
+/* matrix summation over a memory-mapped binmatrix file using pthreads
+
+   features: join-based sum/min/max as in matrixSum.taskB.c, but the
+             matrix is the mapped file itself (any rows x cols, padded
+             rows allowed), so there is no parsing or copying step.
+
+   usage under Linux:
+     gcc -O2 matrixSum.mmap.c -lpthread
+     a.out file numWorkers populate
+
+   populate = 1 prefaults the mapping with MAP_POPULATE, so the timed
+   part measures the reduction rather than page faults.
+*/
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <sys/time.h>
+#include <limits.h>
+#include "binmatrix.h"
+
+#define MAXWORKERS 10 /* Maximum number of workers */
+
+/* Struct to store a matrix element's value and position */
+typedef struct {
+    int row;
+    int col;
+    int value;
+} MatrixElement;
+
+/* Struct to store thread-local results */
+typedef struct {
+    long long localSum;
+    MatrixElement localMax;
+    MatrixElement localMin;
+} ThreadResult;
+
+/* Global Variables */
+int rows, cols, numWorkers, stripSize;  /* Matrix shape, number of workers, strip size */
+BinMatrix matrix;                       /* Mapped matrix file */
+
+/* Function Prototypes */
+double read_timer();
+void *Worker(void *);
+
+/* Main Function */
+int main(int argc, char *argv[]) {
+    pthread_t workers[MAXWORKERS];
+    pthread_attr_t attr;
+    long t;
+
+    if (argc < 2) {
+        printf("Usage: %s file numWorkers populate\n", argv[0]);
+        return 1;
+    }
+
+    /* Read command-line arguments */
+    numWorkers = (argc > 2) ? atoi(argv[2]) : MAXWORKERS;
+    int populate = (argc > 3) ? atoi(argv[3]) : 0;
+    if (numWorkers > MAXWORKERS) numWorkers = MAXWORKERS;
+    if (numWorkers < 1) numWorkers = 1;
+
+    /* Map the matrix */
+    if (binmatrixOpen(argv[1], populate ? BINMATRIX_POPULATE : BINMATRIX_SEQUENTIAL, &matrix) < 0) {
+        return 1;
+    }
+    if (matrix.header.dtype != DTYPE_INT32 || matrix.header.rows > INT_MAX || matrix.header.cols > INT_MAX) {
+        printf("Only int32 matrices with int-sized dimensions are supported\n");
+        return 1;
+    }
+    rows = (int)matrix.header.rows;
+    cols = (int)matrix.header.cols;
+    stripSize = rows / numWorkers;
+
+    /* Set thread attributes */
+    pthread_attr_init(&attr);
+    pthread_attr_setscope(&attr, PTHREAD_SCOPE_SYSTEM);
+
+    /* Start timer */
+    double start_time = read_timer();
+
+    for (t = 0; t < numWorkers; t++) {
+        pthread_create(&workers[t], &attr, Worker, (void *)t);
+    }
+
+    /* Aggregate results */
+    long long totalSum = 0;
+    MatrixElement globalMax = { .value = INT_MIN };
+    MatrixElement globalMin = { .value = INT_MAX };
+
+    for (t = 0; t < numWorkers; t++) {
+        ThreadResult *result;
+        pthread_join(workers[t], (void **)&result);
+
+        totalSum += result->localSum;
+
+        if (result->localMax.value > globalMax.value) {
+            globalMax = result->localMax;
+        }
+        if (result->localMin.value < globalMin.value) {
+            globalMin = result->localMin;
+        }
+
+        /* Free the memory allocated by the thread */
+        free(result);
+    }
+
+    /* Stop timer */
+    double end_time = read_timer();
+
+    /* Print results */
+    printf("Matrix: %d x %d (stride %llu)\n", rows, cols, (unsigned long long)matrix.header.stride);
+    printf("The total sum is: %lld\n", totalSum);
+    printf("The maximum value is %d at position (%d, %d)\n", globalMax.value, globalMax.row, globalMax.col);
+    printf("The minimum value is %d at position (%d, %d)\n", globalMin.value, globalMin.row, globalMin.col);
+    printf("Execution time: %g sec\n", end_time - start_time);
+
+    binmatrixClose(&matrix);
+    return 0;
+}
+
+/* Worker Function */
+void *Worker(void *arg) {
+    long id = (long)arg;
+    int firstRow = id * stripSize;
+    int lastRow = (id == numWorkers - 1) ? rows - 1 : (firstRow + stripSize - 1);
+
+    /* Allocate memory for the thread's result */
+    ThreadResult *result = (ThreadResult *)malloc(sizeof(ThreadResult));
+    result->localSum = 0;
+    result->localMax = (MatrixElement){ .value = INT_MIN };
+    result->localMin = (MatrixElement){ .value = INT_MAX };
+
+    /* Process assigned strip */
+    for (int i = firstRow; i <= lastRow; i++) {
+        const int32_t *row = (const int32_t *)binmatrixRow(&matrix, i);
+        for (int j = 0; j < cols; j++) {
+            result->localSum += row[j];
+            if (row[j] > result->localMax.value) {
+                result->localMax = (MatrixElement){ .row = i, .col = j, .value = row[j] };
+            }
+            if (row[j] < result->localMin.value) {
+                result->localMin = (MatrixElement){ .row = i, .col = j, .value = row[j] };
+            }
+        }
+    }
+
+    /* Return the result */
+    return (void *)result;
+}
+
+/* Timer Function */
+double read_timer() {
+    static struct timeval start;
+    static int initialized = 0;
+    struct timeval end;
+
+    if (!initialized) {
+        gettimeofday(&start, NULL);
+        initialized = 1;
+    }
+
+    gettimeofday(&end, NULL);
+    return (end.tv_sec - start.tv_sec) + 1.0e-6 * (end.tv_usec - start.tv_usec);
+}
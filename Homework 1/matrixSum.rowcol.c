@@ -0,0 +1,293 @@
+/* per-row and per-column statistics using pthreads
+
+   features: computes the sum, min and max (with positions) of every row
+             and every column in one pass. Each worker takes a strip of
+             rows as in matrixSum.c and walks it in tiles of TILE_ROWS x
+             TILE_COLS, so the column accumulators of the tile stay in
+             L1 while its rows stream past. Column accumulators are
+             private to each worker; after a barrier the workers merge
+             them column slice by column slice. Every band of TILE_ROWS
+             rows is final as soon as it is done and is written to the
+             row file straight away, so row results appear while the
+             rest of the matrix is still being read.
+
+             A serial version that walks the columns of the row-major
+             matrix directly is timed for comparison.
+
+   usage under Linux:
+     gcc -O2 matrixSum.rowcol.c -lpthread
+     a.out size numWorkers seed rowFile colFile
+
+   rowFile and colFile are optional; "-" is standard output. Ties go to
+   the lowest index.
+*/
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <limits.h>
+
+#define MAXSIZE    10000  /* Maximum matrix size */
+#define MAXWORKERS 10     /* Maximum number of workers */
+#define TILE_ROWS  16     /* Rows per tile, and per streamed band */
+#define TILE_COLS  1024   /* Columns per tile */
+
+/* Sum, min and max of one row or column; the positions are the
+   column (for a row) or the row (for a column) of the extreme */
+typedef struct {
+    long long sum;
+    int min, minAt;
+    int max, maxAt;
+} LineStats;
+
+/* Global Variables */
+int size, numWorkers, stripSize;   /* Matrix size, number of workers, strip size */
+int matrix[MAXSIZE][MAXSIZE];      /* Matrix */
+LineStats *rowStats, *colStats;    /* Results */
+LineStats *privateCols[MAXWORKERS];/* Per-worker column accumulators */
+FILE *rowFile;                     /* Where finished bands go, or NULL */
+pthread_mutex_t outputLock = PTHREAD_MUTEX_INITIALIZER;
+
+pthread_mutex_t barrier = PTHREAD_MUTEX_INITIALIZER;  /* mutex lock for the barrier */
+pthread_cond_t go = PTHREAD_COND_INITIALIZER;         /* condition variable for leaving */
+int numArrived = 0;                                   /* number who have arrived */
+
+/* a reusable counter barrier */
+void Barrier() {
+    pthread_mutex_lock(&barrier);
+    numArrived++;
+    if (numArrived == numWorkers) {
+        numArrived = 0;
+        pthread_cond_broadcast(&go);
+    } else {
+        pthread_cond_wait(&go, &barrier);
+    }
+    pthread_mutex_unlock(&barrier);
+}
+
+/* Function Prototypes */
+double read_timer();
+void initializeMatrix(int seed);
+void *Worker(void *);
+
+static void resetStats(LineStats *stats, int n) {
+    for (int i = 0; i < n; i++) {
+        stats[i] = (LineStats){ 0, INT_MAX, 0, INT_MIN, 0 };
+    }
+}
+
+static void printStats(FILE *file, const char *kind, int index, const LineStats *s) {
+    fprintf(file, "%s %d: sum %lld min %d at %d max %d at %d\n",
+            kind, index, s->sum, s->min, s->minAt, s->max, s->maxAt);
+}
+
+/* Serial reference: rows in order, then columns walked down the matrix */
+static void serialStats(LineStats *rows, LineStats *cols) {
+    resetStats(rows, size);
+    resetStats(cols, size);
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            int v = matrix[i][j];
+            rows[i].sum += v;
+            if (v < rows[i].min) { rows[i].min = v; rows[i].minAt = j; }
+            if (v > rows[i].max) { rows[i].max = v; rows[i].maxAt = j; }
+        }
+    }
+    for (int j = 0; j < size; j++) {
+        for (int i = 0; i < size; i++) {
+            int v = matrix[i][j];
+            cols[j].sum += v;
+            if (v < cols[j].min) { cols[j].min = v; cols[j].minAt = i; }
+            if (v > cols[j].max) { cols[j].max = v; cols[j].maxAt = i; }
+        }
+    }
+}
+
+/* Main Function */
+int main(int argc, char *argv[]) {
+    pthread_t workers[MAXWORKERS];
+    pthread_attr_t attr;
+    long t;
+
+    /* Read command-line arguments */
+    size = (argc > 1) ? atoi(argv[1]) : MAXSIZE;
+    numWorkers = (argc > 2) ? atoi(argv[2]) : MAXWORKERS;
+    int seed = (argc > 3) ? atoi(argv[3]) : -1; // Default to -1 for no specific seed
+    const char *rowPath = (argc > 4) ? argv[4] : NULL;
+    const char *colPath = (argc > 5) ? argv[5] : NULL;
+    if (size > MAXSIZE) size = MAXSIZE;
+    if (size < 1) size = 1;
+    if (numWorkers > MAXWORKERS) numWorkers = MAXWORKERS;
+    if (numWorkers > size) numWorkers = size;
+    if (numWorkers < 1) numWorkers = 1;
+    stripSize = size / numWorkers;
+
+    rowFile = NULL;
+    if (rowPath) {
+        rowFile = (strcmp(rowPath, "-") == 0) ? stdout : fopen(rowPath, "w");
+        if (!rowFile) {
+            printf("Cannot open %s\n", rowPath);
+            return 1;
+        }
+    }
+
+    /* Initialize matrix and result vectors */
+    initializeMatrix(seed);
+    rowStats = (LineStats *)malloc(sizeof(LineStats) * size);
+    colStats = (LineStats *)malloc(sizeof(LineStats) * size);
+    for (t = 0; t < numWorkers; t++) {
+        privateCols[t] = (LineStats *)malloc(sizeof(LineStats) * size);
+    }
+
+    /* Set thread attributes */
+    pthread_attr_init(&attr);
+    pthread_attr_setscope(&attr, PTHREAD_SCOPE_SYSTEM);
+
+    /* Start timer */
+    double start_time = read_timer();
+    for (t = 0; t < numWorkers; t++) {
+        pthread_create(&workers[t], &attr, Worker, (void *)t);
+    }
+    for (t = 0; t < numWorkers; t++) {
+        pthread_join(workers[t], NULL);
+    }
+    double end_time = read_timer();
+
+    /* Serial column-walking reference */
+    LineStats *checkRows = (LineStats *)malloc(sizeof(LineStats) * size);
+    LineStats *checkCols = (LineStats *)malloc(sizeof(LineStats) * size);
+    double serial_start = read_timer();
+    serialStats(checkRows, checkCols);
+    double serial_end = read_timer();
+    bool agree = memcmp(rowStats, checkRows, sizeof(LineStats) * size) == 0 &&
+                 memcmp(colStats, checkCols, sizeof(LineStats) * size) == 0;
+
+    if (colPath) {
+        FILE *colFile = (strcmp(colPath, "-") == 0) ? stdout : fopen(colPath, "w");
+        if (!colFile) {
+            printf("Cannot open %s\n", colPath);
+        } else {
+            for (int j = 0; j < size; j++) printStats(colFile, "col", j, &colStats[j]);
+            if (colFile != stdout) fclose(colFile);
+        }
+    }
+    if (rowFile && rowFile != stdout) fclose(rowFile);
+
+    /* the grand total both ways */
+    long long byRows = 0, byCols = 0;
+    for (int i = 0; i < size; i++) {
+        byRows += rowStats[i].sum;
+        byCols += colStats[i].sum;
+    }
+
+    /* Print results */
+    printf("The total sum is: %lld (by columns %lld)\n", byRows, byCols);
+    printf("Execution time (tiled, %d workers): %g sec\n", numWorkers, end_time - start_time);
+    printf("Execution time (serial, column walk): %g sec\n", serial_end - serial_start);
+    printf("Results agree? %s\n", agree ? "True" : "False");
+
+    for (t = 0; t < numWorkers; t++) free(privateCols[t]);
+    free(rowStats);
+    free(colStats);
+    free(checkRows);
+    free(checkCols);
+    return 0;
+}
+
+/* Worker Function */
+void *Worker(void *arg) {
+    long id = (long)arg;
+    int firstRow = id * stripSize;
+    int lastRow = (id == numWorkers - 1) ? size - 1 : (firstRow + stripSize - 1);
+    LineStats *cols = privateCols[id];
+
+    resetStats(cols, size);
+
+    /* Process assigned strip one band of TILE_ROWS rows at a time */
+    for (int band = firstRow; band <= lastRow; band += TILE_ROWS) {
+        int bandEnd = (band + TILE_ROWS - 1 < lastRow) ? band + TILE_ROWS - 1 : lastRow;
+        resetStats(&rowStats[band], bandEnd - band + 1);
+
+        for (int tile = 0; tile < size; tile += TILE_COLS) {
+            int tileEnd = (tile + TILE_COLS < size) ? tile + TILE_COLS : size;
+            for (int i = band; i <= bandEnd; i++) {
+                LineStats row = rowStats[i];
+                for (int j = tile; j < tileEnd; j++) {
+                    int v = matrix[i][j];
+                    row.sum += v;
+                    if (v < row.min) { row.min = v; row.minAt = j; }
+                    if (v > row.max) { row.max = v; row.maxAt = j; }
+                    cols[j].sum += v;
+                    if (v < cols[j].min) { cols[j].min = v; cols[j].minAt = i; }
+                    if (v > cols[j].max) { cols[j].max = v; cols[j].maxAt = i; }
+                }
+                rowStats[i] = row;
+            }
+        }
+
+        /* the band's rows are final: stream them out */
+        if (rowFile) {
+            pthread_mutex_lock(&outputLock);
+            for (int i = band; i <= bandEnd; i++) printStats(rowFile, "row", i, &rowStats[i]);
+            fflush(rowFile);
+            pthread_mutex_unlock(&outputLock);
+        }
+    }
+
+    Barrier();
+
+    /* merge the private column accumulators, one slice of columns each;
+       workers hold strips in row order, so the first strict win is the
+       lowest row */
+    int colSlice = size / numWorkers;
+    int firstCol = id * colSlice;
+    int lastCol = (id == numWorkers - 1) ? size - 1 : (firstCol + colSlice - 1);
+    for (int j = firstCol; j <= lastCol; j++) {
+        LineStats merged = privateCols[0][j];
+        for (int w = 1; w < numWorkers; w++) {
+            LineStats *s = &privateCols[w][j];
+            merged.sum += s->sum;
+            if (s->min < merged.min) { merged.min = s->min; merged.minAt = s->minAt; }
+            if (s->max > merged.max) { merged.max = s->max; merged.maxAt = s->maxAt; }
+        }
+        colStats[j] = merged;
+    }
+
+    return NULL;
+}
+
+/* Timer Function */
+double read_timer() {
+    static struct timeval start;
+    static int initialized = 0;
+    struct timeval end;
+
+    if (!initialized) {
+        gettimeofday(&start, NULL);
+        initialized = 1;
+    }
+
+    gettimeofday(&end, NULL);
+    return (end.tv_sec - start.tv_sec) + 1.0e-6 * (end.tv_usec - start.tv_usec);
+}
+
+/* Initialize Matrix */
+void initializeMatrix(int seed) {
+    if (seed >= 0) {
+        srand(seed); // Use the provided seed for reproducibility
+    } else {
+        srand(time(NULL)); // Use the current time for randomness
+    }
+
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            matrix[i][j] = rand() % 100; /* Random values [0, 99] */
+        }
+    }
+}
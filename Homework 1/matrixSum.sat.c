@@ -0,0 +1,261 @@
+/* summed-area table and rectangle sums using pthreads
+
+   features: builds the 2D prefix sum S of the matrix with 64-bit entries,
+             S[i][j] = sum of matrix[0..i-1][0..j-1], so any rectangle
+             sum is four lookups. The build is two passes separated by a
+             barrier: a row-parallel pass of running row sums (each
+             worker owns a strip of rows, as in matrixSum.c), then a
+             column pass where each worker owns blocks of COL_BLOCK
+             columns and carries them down the rows, so every row
+             segment it touches is contiguous.
+
+             rectSumBatch answers an array of queries, split across the
+             workers. The program reports build time and queries/sec,
+             and checks a sample of the answers against direct sums.
+
+   usage under Linux:
+     gcc -O2 matrixSum.sat.c -lpthread
+     a.out size numWorkers seed numQueries
+
+   The table takes 8 * (size + 1)^2 bytes.
+*/
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <sys/time.h>
+
+#define MAXSIZE    10000    /* Maximum matrix size */
+#define MAXWORKERS 10       /* Maximum number of workers */
+#define COL_BLOCK  256      /* Columns per block in the column pass */
+#define QUERIES    10000000 /* Default number of queries */
+#define CHECKED    1000     /* Queries checked against a direct sum */
+
+/* A rectangle of the matrix, bounds inclusive */
+typedef struct {
+    int top, left;
+    int bottom, right;
+} Rect;
+
+/* Global Variables */
+int size, numWorkers, stripSize;  /* Matrix size, number of workers, strip size */
+int matrix[MAXSIZE][MAXSIZE];     /* Matrix */
+long long *table;                 /* (size + 1) x (size + 1) summed-area table */
+int stride;                       /* Row length of the table */
+
+pthread_mutex_t barrier = PTHREAD_MUTEX_INITIALIZER;  /* mutex lock for the barrier */
+pthread_cond_t go = PTHREAD_COND_INITIALIZER;         /* condition variable for leaving */
+int numArrived = 0;                                   /* number who have arrived */
+
+/* a reusable counter barrier */
+void Barrier() {
+    pthread_mutex_lock(&barrier);
+    numArrived++;
+    if (numArrived == numWorkers) {
+        numArrived = 0;
+        pthread_cond_broadcast(&go);
+    } else {
+        pthread_cond_wait(&go, &barrier);
+    }
+    pthread_mutex_unlock(&barrier);
+}
+
+/* Function Prototypes */
+double read_timer();
+void initializeMatrix(int seed);
+void *BuildWorker(void *);
+void *QueryWorker(void *);
+
+/* Sum of the rectangle r in O(1) */
+static inline long long rectSum(Rect r) {
+    const long long *above = table + (size_t)r.top * stride;
+    const long long *below = table + (size_t)(r.bottom + 1) * stride;
+    return below[r.right + 1] - below[r.left] - above[r.right + 1] + above[r.left];
+}
+
+/* Struct for passing a slice of a query batch to a thread */
+typedef struct {
+    const Rect *rects;
+    long long *sums;
+    long first, last;  /* queries [first, last) */
+} QueryTask;
+
+/* Answer queries[0..n) into sums[0..n) using numWorkers threads */
+void rectSumBatch(const Rect *rects, long n, long long *sums) {
+    pthread_t workers[MAXWORKERS];
+    QueryTask tasks[MAXWORKERS];
+    for (int t = 0; t < numWorkers; t++) {
+        tasks[t] = (QueryTask){ rects, sums, n * t / numWorkers, n * (t + 1) / numWorkers };
+        pthread_create(&workers[t], NULL, QueryWorker, &tasks[t]);
+    }
+    for (int t = 0; t < numWorkers; t++) {
+        pthread_join(workers[t], NULL);
+    }
+}
+
+void *QueryWorker(void *arg) {
+    QueryTask *task = (QueryTask *)arg;
+    for (long q = task->first; q < task->last; q++) {
+        task->sums[q] = rectSum(task->rects[q]);
+    }
+    return NULL;
+}
+
+/* Sum of the rectangle r by scanning it */
+static long long directSum(Rect r) {
+    long long sum = 0;
+    for (int i = r.top; i <= r.bottom; i++) {
+        for (int j = r.left; j <= r.right; j++) {
+            sum += matrix[i][j];
+        }
+    }
+    return sum;
+}
+
+/* Main Function */
+int main(int argc, char *argv[]) {
+    pthread_t workers[MAXWORKERS];
+    pthread_attr_t attr;
+    long t;
+
+    /* Read command-line arguments */
+    size = (argc > 1) ? atoi(argv[1]) : MAXSIZE;
+    numWorkers = (argc > 2) ? atoi(argv[2]) : MAXWORKERS;
+    int seed = (argc > 3) ? atoi(argv[3]) : -1; // Default to -1 for no specific seed
+    long numQueries = (argc > 4) ? atol(argv[4]) : QUERIES;
+    if (size > MAXSIZE) size = MAXSIZE;
+    if (size < 1) size = 1;
+    if (numWorkers > MAXWORKERS) numWorkers = MAXWORKERS;
+    if (numWorkers > size) numWorkers = size;
+    if (numWorkers < 1) numWorkers = 1;
+    if (numQueries < 0) numQueries = 0;
+    stripSize = size / numWorkers;
+
+    /* Initialize matrix and table; row 0 and column 0 stay zero */
+    initializeMatrix(seed);
+    stride = size + 1;
+    table = (long long *)calloc((size_t)stride * stride, sizeof(long long));
+    Rect *rects = (Rect *)malloc(sizeof(Rect) * (numQueries > 0 ? numQueries : 1));
+    long long *sums = (long long *)malloc(sizeof(long long) * (numQueries > 0 ? numQueries : 1));
+    if (!table || !rects || !sums) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+
+    /* random rectangles with corners anywhere in the matrix */
+    for (long q = 0; q < numQueries; q++) {
+        int r0 = rand() % size, r1 = rand() % size;
+        int c0 = rand() % size, c1 = rand() % size;
+        rects[q] = (Rect){ r0 < r1 ? r0 : r1, c0 < c1 ? c0 : c1, r0 < r1 ? r1 : r0, c0 < c1 ? c1 : c0 };
+    }
+
+    /* Set thread attributes */
+    pthread_attr_init(&attr);
+    pthread_attr_setscope(&attr, PTHREAD_SCOPE_SYSTEM);
+
+    /* Build the table */
+    double start_time = read_timer();
+    for (t = 0; t < numWorkers; t++) {
+        pthread_create(&workers[t], &attr, BuildWorker, (void *)t);
+    }
+    for (t = 0; t < numWorkers; t++) {
+        pthread_join(workers[t], NULL);
+    }
+    double build_time = read_timer();
+
+    /* Answer the batch */
+    rectSumBatch(rects, numQueries, sums);
+    double end_time = read_timer();
+
+    /* Check a sample against direct sums, and the whole matrix */
+    bool correct = true;
+    long checked = (numQueries < CHECKED) ? numQueries : CHECKED;
+    for (long q = 0; q < checked; q++) {
+        if (sums[q] != directSum(rects[q])) correct = false;
+    }
+    Rect whole = { 0, 0, size - 1, size - 1 };
+    long long total = rectSum(whole);
+    if (total != directSum(whole)) correct = false;
+
+    /* Print results */
+    double queryTime = end_time - build_time;
+    printf("The total sum is: %lld\n", total);
+    printf("Build time: %g sec (%.1f MB/s of matrix)\n", build_time - start_time,
+           (double)size * size * sizeof(int) / (build_time - start_time) / 1e6);
+    printf("Query time: %g sec for %ld queries (%.1f Mqueries/s)\n", queryTime, numQueries,
+           (queryTime > 0) ? numQueries / queryTime / 1e6 : 0.0);
+    printf("Sampled sums correct? %s\n", correct ? "True" : "False");
+
+    free(table);
+    free(rects);
+    free(sums);
+    return 0;
+}
+
+/* Build Worker: row pass over my strip, barrier, column pass over my blocks */
+void *BuildWorker(void *arg) {
+    long id = (long)arg;
+    int firstRow = id * stripSize;
+    int lastRow = (id == numWorkers - 1) ? size - 1 : (firstRow + stripSize - 1);
+
+    /* running sums along each row of my strip */
+    for (int i = firstRow; i <= lastRow; i++) {
+        long long *out = table + (size_t)(i + 1) * stride;
+        long long running = 0;
+        for (int j = 0; j < size; j++) {
+            running += matrix[i][j];
+            out[j + 1] = running;
+        }
+    }
+
+    Barrier();
+
+    /* carry blocks of columns down the table; block b goes to worker b % numWorkers */
+    for (int block = id * COL_BLOCK; block < size; block += numWorkers * COL_BLOCK) {
+        int first = block + 1;
+        int last = (block + COL_BLOCK < size) ? block + COL_BLOCK : size;
+        for (int i = 2; i <= size; i++) {
+            long long *out = table + (size_t)i * stride;
+            const long long *above = out - stride;
+            for (int j = first; j <= last; j++) {
+                out[j] += above[j];
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/* Timer Function */
+double read_timer() {
+    static struct timeval start;
+    static int initialized = 0;
+    struct timeval end;
+
+    if (!initialized) {
+        gettimeofday(&start, NULL);
+        initialized = 1;
+    }
+
+    gettimeofday(&end, NULL);
+    return (end.tv_sec - start.tv_sec) + 1.0e-6 * (end.tv_usec - start.tv_usec);
+}
+
+/* Initialize Matrix */
+void initializeMatrix(int seed) {
+    if (seed >= 0) {
+        srand(seed); // Use the provided seed for reproducibility
+    } else {
+        srand(time(NULL)); // Use the current time for randomness
+    }
+
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            matrix[i][j] = rand() % 100; /* Random values [0, 99] */
+        }
+    }
+}
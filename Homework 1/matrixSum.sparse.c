@@ -0,0 +1,354 @@
+/* sparse (CSR) matrix summation using pthreads
+
+   features: the matrix is stored in compressed sparse row form, so only
+             the nonzeros are scanned. Work is handed out as a bag of
+             tasks as in matrixSum.taskC.c, but a task is a fixed number
+             of nonzeros rather than a row: a task may start or end in
+             the middle of a long row, so a few very full rows cannot
+             leave the other workers idle. The row-at-a-time bag is run
+             as well for comparison.
+
+             Implicit zeros count towards min and max: if the matrix has
+             any, 0 competes at the first implicit zero in row-major
+             order. Ties on value go to the earlier position.
+
+   usage under Linux:
+     gcc -O2 matrixSum.sparse.c -lpthread
+     a.out size numWorkers seed density skew
+     a.out -f file numWorkers
+
+   density is the percentage of nonzero cells (default 1). skew = 1 gives
+   row i a share of the nonzeros proportional to 1 / (i + 1). -f reads a
+   dense int32 binmatrix file and compresses it first.
+*/
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <limits.h>
+#include "binmatrix.h"
+
+#define MAXWORKERS 10     /* Maximum number of workers */
+#define TASK_NNZ   16384  /* Nonzeros per task */
+
+/* Struct to store a matrix element's value and position */
+typedef struct {
+    int row;
+    int col;
+    int value;
+} MatrixElement;
+
+/* Struct to store thread-local results */
+typedef struct {
+    long long localSum;
+    MatrixElement localMax;
+    MatrixElement localMin;
+} ThreadResult;
+
+/* Compressed sparse row matrix */
+typedef struct {
+    int rows, cols;
+    long long nnz;
+    long long *rowPtr;   /* row i holds entries [rowPtr[i], rowPtr[i + 1]) */
+    int *colIdx;         /* ascending within a row */
+    int *values;
+} CsrMatrix;
+
+/* Global Variables */
+int numWorkers;                   /* Number of workers */
+CsrMatrix matrix;                 /* Matrix */
+long long nextTask = 0;           /* Shared counter for "bag of tasks" */
+long long numTasks;               /* Tasks in the bag */
+bool byRow;                       /* Tasks are rows rather than nnz chunks */
+pthread_mutex_t taskLock;         /* Mutex Lock for shared counter */
+
+/* Function Prototypes */
+double read_timer();
+void generateMatrix(int size, int seed, double density, int skew);
+int loadMatrix(const char *path);
+void *Worker(void *);
+
+/* Is a before b in row-major order? */
+static bool before(MatrixElement a, MatrixElement b) {
+    return a.row < b.row || (a.row == b.row && a.col < b.col);
+}
+
+/* Merge a partial result into the running one */
+static void combine(ThreadResult *into, const ThreadResult *from) {
+    into->localSum += from->localSum;
+    if (from->localMax.value > into->localMax.value ||
+        (from->localMax.value == into->localMax.value && before(from->localMax, into->localMax))) {
+        into->localMax = from->localMax;
+    }
+    if (from->localMin.value < into->localMin.value ||
+        (from->localMin.value == into->localMin.value && before(from->localMin, into->localMin))) {
+        into->localMin = from->localMin;
+    }
+}
+
+/* Reduce entries [first, last) of the matrix into result */
+static void reduceRange(long long first, long long last, ThreadResult *result) {
+    /* the row holding entry first: last i with rowPtr[i] <= first */
+    int low = 0, high = matrix.rows - 1;
+    while (low < high) {
+        int mid = low + (high - low + 1) / 2;
+        if (matrix.rowPtr[mid] <= first) low = mid;
+        else high = mid - 1;
+    }
+
+    int row = low;
+    for (long long k = first; k < last; k++) {
+        while (matrix.rowPtr[row + 1] <= k) row++;
+        int value = matrix.values[k];
+        result->localSum += value;
+        if (value > result->localMax.value) {
+            result->localMax = (MatrixElement){ .row = row, .col = matrix.colIdx[k], .value = value };
+        }
+        if (value < result->localMin.value) {
+            result->localMin = (MatrixElement){ .row = row, .col = matrix.colIdx[k], .value = value };
+        }
+    }
+}
+
+/* Position of the first implicit zero in row-major order; false if none */
+static bool firstImplicitZero(MatrixElement *zero) {
+    for (int i = 0; i < matrix.rows; i++) {
+        long long start = matrix.rowPtr[i];
+        long long length = matrix.rowPtr[i + 1] - start;
+        if (length == matrix.cols) continue;
+        int j = 0;
+        while (j < length && matrix.colIdx[start + j] == j) j++;
+        *zero = (MatrixElement){ .row = i, .col = j, .value = 0 };
+        return true;
+    }
+    return false;
+}
+
+/* Run the workers over the bag and combine their results */
+static ThreadResult runBag(bool rows, double *seconds) {
+    pthread_t workers[MAXWORKERS];
+    pthread_attr_t attr;
+    long t;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setscope(&attr, PTHREAD_SCOPE_SYSTEM);
+
+    byRow = rows;
+    nextTask = 0;
+    numTasks = rows ? matrix.rows : (matrix.nnz + TASK_NNZ - 1) / TASK_NNZ;
+
+    double start_time = read_timer();
+    for (t = 0; t < numWorkers; t++) {
+        pthread_create(&workers[t], &attr, Worker, (void *)t);
+    }
+
+    ThreadResult total = { 0, { .value = INT_MIN }, { .value = INT_MAX } };
+    for (t = 0; t < numWorkers; t++) {
+        ThreadResult *result;
+        pthread_join(workers[t], (void **)&result);
+        combine(&total, result);
+        free(result);
+    }
+
+    /* implicit zeros take part in min and max */
+    MatrixElement zero;
+    if (firstImplicitZero(&zero)) {
+        ThreadResult zeros = { 0, zero, zero };
+        combine(&total, &zeros);
+    }
+    *seconds = read_timer() - start_time;
+    return total;
+}
+
+/* Main Function */
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "-f") == 0) {
+        if (argc < 3) {
+            printf("Usage: %s -f file numWorkers\n", argv[0]);
+            return 1;
+        }
+        if (loadMatrix(argv[2]) < 0) return 1;
+        numWorkers = (argc > 3) ? atoi(argv[3]) : MAXWORKERS;
+    } else {
+        int size = (argc > 1) ? atoi(argv[1]) : 10000;
+        numWorkers = (argc > 2) ? atoi(argv[2]) : MAXWORKERS;
+        int seed = (argc > 3) ? atoi(argv[3]) : -1; // Default to -1 for no specific seed
+        double density = (argc > 4) ? atof(argv[4]) : 1.0;
+        int skew = (argc > 5) ? atoi(argv[5]) : 0;
+        if (size < 1) size = 1;
+        if (density < 0) density = 0;
+        if (density > 100) density = 100;
+        generateMatrix(size, seed, density, skew);
+    }
+    if (numWorkers > MAXWORKERS) numWorkers = MAXWORKERS;
+    if (numWorkers < 1) numWorkers = 1;
+    pthread_mutex_init(&taskLock, NULL);
+
+    double rowTime, nnzTime;
+    ThreadResult rowResult = runBag(true, &rowTime);
+    ThreadResult nnzResult = runBag(false, &nnzTime);
+
+    pthread_mutex_destroy(&taskLock);
+
+    bool agree = rowResult.localSum == nnzResult.localSum &&
+                 memcmp(&rowResult.localMax, &nnzResult.localMax, sizeof(MatrixElement)) == 0 &&
+                 memcmp(&rowResult.localMin, &nnzResult.localMin, sizeof(MatrixElement)) == 0;
+
+    /* Print results */
+    printf("Matrix: %d x %d, %lld nonzeros (%.2f%%)\n", matrix.rows, matrix.cols, matrix.nnz,
+           100.0 * matrix.nnz / ((double)matrix.rows * matrix.cols));
+    printf("The total sum is: %lld\n", nnzResult.localSum);
+    printf("The maximum value is %d at position (%d, %d)\n",
+           nnzResult.localMax.value, nnzResult.localMax.row, nnzResult.localMax.col);
+    printf("The minimum value is %d at position (%d, %d)\n",
+           nnzResult.localMin.value, nnzResult.localMin.row, nnzResult.localMin.col);
+    printf("Execution time (row tasks): %g sec\n", rowTime);
+    printf("Execution time (nnz tasks): %g sec\n", nnzTime);
+    printf("Results agree? %s\n", agree ? "True" : "False");
+
+    free(matrix.rowPtr);
+    free(matrix.colIdx);
+    free(matrix.values);
+    return 0;
+}
+
+/* Worker Function */
+void *Worker(void *arg) {
+    (void)arg;
+    long long task;
+
+    /* Allocate memory for the thread's result */
+    ThreadResult *result = (ThreadResult *)malloc(sizeof(ThreadResult));
+    result->localSum = 0;
+    result->localMax = (MatrixElement){ .value = INT_MIN };
+    result->localMin = (MatrixElement){ .value = INT_MAX };
+
+    while (1) {
+        /* Critical section: Get a task from the shared counter */
+        pthread_mutex_lock(&taskLock);
+        task = nextTask;
+        nextTask++;
+        pthread_mutex_unlock(&taskLock);
+
+        /* Check if all tasks are processed */
+        if (task >= numTasks) {
+            break;
+        }
+
+        /* Process the assigned row or run of nonzeros */
+        if (byRow) {
+            reduceRange(matrix.rowPtr[task], matrix.rowPtr[task + 1], result);
+        } else {
+            long long last = (task + 1) * TASK_NNZ;
+            reduceRange(task * TASK_NNZ, (last < matrix.nnz) ? last : matrix.nnz, result);
+        }
+    }
+
+    /* Return the result */
+    return (void *)result;
+}
+
+/* Timer Function */
+double read_timer() {
+    static struct timeval start;
+    static int initialized = 0;
+    struct timeval end;
+
+    if (!initialized) {
+        gettimeofday(&start, NULL);
+        initialized = 1;
+    }
+
+    gettimeofday(&end, NULL);
+    return (end.tv_sec - start.tv_sec) + 1.0e-6 * (end.tv_usec - start.tv_usec);
+}
+
+/* Generate a random size x size CSR matrix with nonzeros in [-99, 99] */
+void generateMatrix(int size, int seed, double density, int skew) {
+    if (seed >= 0) {
+        srand(seed); // Use the provided seed for reproducibility
+    } else {
+        srand(time(NULL)); // Use the current time for randomness
+    }
+
+    long long target = (long long)(density / 100.0 * size * (double)size);
+    matrix.rows = matrix.cols = size;
+    matrix.rowPtr = (long long *)malloc(sizeof(long long) * (size + 1));
+
+    /* row lengths: even, or proportional to 1 / (i + 1) */
+    double harmonic = 0;
+    for (int i = 0; i < size; i++) harmonic += 1.0 / (i + 1);
+    matrix.rowPtr[0] = 0;
+    for (int i = 0; i < size; i++) {
+        long long length = skew ? (long long)(target / harmonic / (i + 1)) : target / size + (i < target % size);
+        if (length > size) length = size;
+        matrix.rowPtr[i + 1] = matrix.rowPtr[i] + length;
+    }
+    matrix.nnz = matrix.rowPtr[size];
+    matrix.colIdx = (int *)malloc(sizeof(int) * (matrix.nnz > 0 ? matrix.nnz : 1));
+    matrix.values = (int *)malloc(sizeof(int) * (matrix.nnz > 0 ? matrix.nnz : 1));
+
+    /* ascending columns with random gaps that always leave room for the rest */
+    for (int i = 0; i < size; i++) {
+        long long start = matrix.rowPtr[i];
+        int length = (int)(matrix.rowPtr[i + 1] - start);
+        int j = 0;
+        for (int k = 0; k < length; k++) {
+            int remaining = length - k;
+            int room = size - j - remaining;
+            int gap = (room > 0) ? rand() % (2 * room / remaining + 1) : 0;
+            if (gap > room) gap = room;
+            j += gap;
+            matrix.colIdx[start + k] = j++;
+            int value = rand() % 198 - 98;  /* [-98, 99], 0 moved to -99 */
+            matrix.values[start + k] = (value <= 0) ? value - 1 : value;
+        }
+    }
+}
+
+/* Compress a dense int32 binmatrix file */
+int loadMatrix(const char *path) {
+    BinMatrix dense;
+    if (binmatrixOpen(path, BINMATRIX_SEQUENTIAL, &dense) < 0) {
+        return -1;
+    }
+    if (dense.header.dtype != DTYPE_INT32 || dense.header.rows > INT_MAX - 1 || dense.header.cols > INT_MAX ||
+        dense.header.rows == 0) {
+        printf("Only non-empty int32 matrices with int-sized dimensions are supported\n");
+        return -1;
+    }
+    matrix.rows = (int)dense.header.rows;
+    matrix.cols = (int)dense.header.cols;
+    matrix.rowPtr = (long long *)malloc(sizeof(long long) * (matrix.rows + 1));
+
+    /* count, then fill */
+    matrix.rowPtr[0] = 0;
+    for (int i = 0; i < matrix.rows; i++) {
+        const int32_t *row = (const int32_t *)binmatrixRow(&dense, i);
+        long long count = 0;
+        for (int j = 0; j < matrix.cols; j++) count += (row[j] != 0);
+        matrix.rowPtr[i + 1] = matrix.rowPtr[i] + count;
+    }
+    matrix.nnz = matrix.rowPtr[matrix.rows];
+    matrix.colIdx = (int *)malloc(sizeof(int) * (matrix.nnz > 0 ? matrix.nnz : 1));
+    matrix.values = (int *)malloc(sizeof(int) * (matrix.nnz > 0 ? matrix.nnz : 1));
+    for (int i = 0; i < matrix.rows; i++) {
+        const int32_t *row = (const int32_t *)binmatrixRow(&dense, i);
+        long long k = matrix.rowPtr[i];
+        for (int j = 0; j < matrix.cols; j++) {
+            if (row[j] != 0) {
+                matrix.colIdx[k] = j;
+                matrix.values[k++] = row[j];
+            }
+        }
+    }
+
+    binmatrixClose(&dense);
+    return 0;
+}
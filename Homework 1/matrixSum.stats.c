@@ -0,0 +1,288 @@
+/* single-pass distribution statistics of a matrix using pthreads
+
+   features: one pass over the matrix, split into strips as in
+             matrixSum.c, gives the sum, min and max with positions, a
+             value histogram, the mean and variance, and quantiles.
+
+             Each worker fills a private histogram of 64-bit counters,
+             allocated on its own cache lines so that neighbouring
+             workers never share one. Mean and variance are kept as
+             (count, mean, M2): a row's M2 is summed as (v - rowMean)^2
+             in a second sweep over the row, still in cache, and the row
+             is folded in with Chan's update, so partial results can be
+             merged without losing precision. The workers then merge
+             pairwise in log2(p) rounds separated by barriers,
+             histograms included, and worker 0 prints the result.
+
+             With more distinct values than MAXBINS, a bin covers
+             several values and the quantiles are interpolated within
+             their bin.
+
+   usage under Linux:
+     gcc -O2 matrixSum.stats.c -lpthread -lm
+     a.out size numWorkers seed maxValue
+
+   maxValue defaults to 100 (values [0, 99], as in the other programs).
+*/
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <sys/time.h>
+#include <limits.h>
+
+#define MAXSIZE    10000  /* Maximum matrix size */
+#define MAXWORKERS 10     /* Maximum number of workers */
+#define MAXBINS    4096   /* Maximum histogram bins */
+#define CACHE_LINE 64
+
+/* Struct to store a matrix element's value and position */
+typedef struct {
+    int row;
+    int col;
+    int value;
+} MatrixElement;
+
+/* Everything one worker accumulates, padded to whole cache lines */
+typedef struct {
+    long long sum;
+    MatrixElement max;
+    MatrixElement min;
+    long long count;       /* cells seen */
+    double mean;           /* running mean */
+    double m2;             /* sum of squared deviations from the mean */
+    uint64_t *histogram;   /* numBins counters, cache-line aligned */
+    char pad[CACHE_LINE];
+} WorkerStats;
+
+/* Global Variables */
+int size, numWorkers, stripSize;  /* Matrix size, number of workers, strip size */
+int matrix[MAXSIZE][MAXSIZE];     /* Matrix */
+int maxValue;                     /* Values are in [0, maxValue) */
+int numBins, binWidth;            /* Histogram shape */
+WorkerStats stats[MAXWORKERS];    /* Per-worker accumulators */
+double start_time, end_time;
+
+pthread_mutex_t barrier = PTHREAD_MUTEX_INITIALIZER;  /* mutex lock for the barrier */
+pthread_cond_t go = PTHREAD_COND_INITIALIZER;         /* condition variable for leaving */
+int numArrived = 0;                                   /* number who have arrived */
+
+/* a reusable counter barrier */
+void Barrier() {
+    pthread_mutex_lock(&barrier);
+    numArrived++;
+    if (numArrived == numWorkers) {
+        numArrived = 0;
+        pthread_cond_broadcast(&go);
+    } else {
+        pthread_cond_wait(&go, &barrier);
+    }
+    pthread_mutex_unlock(&barrier);
+}
+
+/* Function Prototypes */
+double read_timer();
+void initializeMatrix(int seed);
+void *Worker(void *);
+
+/* Chan's update: fold n values with the given mean and M2 into s */
+static void mergeMoments(WorkerStats *s, long long n, double mean, double m2) {
+    if (n == 0) return;
+    long long total = s->count + n;
+    double delta = mean - s->mean;
+    s->mean += delta * n / total;
+    s->m2 += m2 + delta * delta * ((double)s->count * n / total);
+    s->count = total;
+}
+
+/* Merge b into a; b holds rows after a's, so ties keep a */
+static void mergeStats(WorkerStats *a, const WorkerStats *b) {
+    a->sum += b->sum;
+    if (b->max.value > a->max.value) a->max = b->max;
+    if (b->min.value < a->min.value) a->min = b->min;
+    mergeMoments(a, b->count, b->mean, b->m2);
+    for (int k = 0; k < numBins; k++) {
+        a->histogram[k] += b->histogram[k];
+    }
+}
+
+/* Value at quantile q (0..1) of the merged histogram */
+static double quantile(const WorkerStats *s, double q) {
+    double target = q * (s->count - 1);
+    uint64_t seen = 0;
+    for (int k = 0; k < numBins; k++) {
+        uint64_t inBin = s->histogram[k];
+        if (inBin > 0 && seen + inBin > target) {
+            /* spread the bin's values evenly over its width */
+            double within = (target - seen + 0.5) / inBin;
+            return (binWidth == 1) ? k : k * (double)binWidth + within * binWidth - 0.5;
+        }
+        seen += inBin;
+    }
+    return maxValue - 1;
+}
+
+/* Main Function */
+int main(int argc, char *argv[]) {
+    pthread_t workers[MAXWORKERS];
+    pthread_attr_t attr;
+    long t;
+
+    /* Read command-line arguments */
+    size = (argc > 1) ? atoi(argv[1]) : MAXSIZE;
+    numWorkers = (argc > 2) ? atoi(argv[2]) : MAXWORKERS;
+    int seed = (argc > 3) ? atoi(argv[3]) : -1; // Default to -1 for no specific seed
+    maxValue = (argc > 4) ? atoi(argv[4]) : 100;
+    if (size > MAXSIZE) size = MAXSIZE;
+    if (size < 1) size = 1;
+    if (numWorkers > MAXWORKERS) numWorkers = MAXWORKERS;
+    if (numWorkers > size) numWorkers = size;
+    if (numWorkers < 1) numWorkers = 1;
+    if (maxValue < 1) maxValue = 1;
+    stripSize = size / numWorkers;
+
+    /* one bin per value while that fits, wider bins otherwise */
+    binWidth = (maxValue + MAXBINS - 1) / MAXBINS;
+    numBins = (maxValue + binWidth - 1) / binWidth;
+    size_t histogramBytes = (sizeof(uint64_t) * numBins + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    for (t = 0; t < numWorkers; t++) {
+        if (posix_memalign((void **)&stats[t].histogram, CACHE_LINE, histogramBytes) != 0) {
+            printf("Memory allocation error!\n");
+            return 1;
+        }
+    }
+
+    initializeMatrix(seed);
+
+    /* Set thread attributes */
+    pthread_attr_init(&attr);
+    pthread_attr_setscope(&attr, PTHREAD_SCOPE_SYSTEM);
+
+    for (t = 0; t < numWorkers; t++) {
+        pthread_create(&workers[t], &attr, Worker, (void *)t);
+    }
+    for (t = 0; t < numWorkers; t++) {
+        pthread_join(workers[t], NULL);
+    }
+
+    for (t = 0; t < numWorkers; t++) free(stats[t].histogram);
+    return 0;
+}
+
+/* Worker Function */
+void *Worker(void *arg) {
+    long id = (long)arg;
+    int firstRow = id * stripSize;
+    int lastRow = (id == numWorkers - 1) ? size - 1 : (firstRow + stripSize - 1);
+    WorkerStats *my = &stats[id];
+
+    my->sum = 0;
+    my->max = (MatrixElement){ .value = INT_MIN };
+    my->min = (MatrixElement){ .value = INT_MAX };
+    my->count = 0;
+    my->mean = 0;
+    my->m2 = 0;
+    memset(my->histogram, 0, sizeof(uint64_t) * numBins);
+
+    Barrier();
+    if (id == 0) start_time = read_timer();
+
+    /* Process assigned strip; exact integer sums per row, the row's
+       squared deviations from its mean, then Chan */
+    for (int i = firstRow; i <= lastRow; i++) {
+        long long rowSum = 0;
+        for (int j = 0; j < size; j++) {
+            int v = matrix[i][j];
+            rowSum += v;
+            my->histogram[v / binWidth]++;
+            if (v > my->max.value) my->max = (MatrixElement){ .row = i, .col = j, .value = v };
+            if (v < my->min.value) my->min = (MatrixElement){ .row = i, .col = j, .value = v };
+        }
+        double rowMean = (double)rowSum / size, rowM2 = 0;
+        for (int j = 0; j < size; j++) {
+            double deviation = matrix[i][j] - rowMean;
+            rowM2 += deviation * deviation;
+        }
+        mergeMoments(my, size, rowMean, rowM2);
+        my->sum += rowSum;
+    }
+
+    /* tree merge: in round r, worker id takes id + r when id is a multiple of 2r */
+    for (int stride = 1; stride < numWorkers; stride *= 2) {
+        Barrier();
+        if (id % (2 * stride) == 0 && id + stride < numWorkers) {
+            mergeStats(my, &stats[id + stride]);
+        }
+    }
+
+    if (id == 0) {
+        end_time = read_timer();
+
+        uint64_t counted = 0;
+        for (int k = 0; k < numBins; k++) counted += my->histogram[k];
+        double variance = (my->count > 1) ? my->m2 / (my->count - 1) : 0.0;
+
+        printf("The total sum is: %lld\n", my->sum);
+        printf("The maximum value is %d at position (%d, %d)\n", my->max.value, my->max.row, my->max.col);
+        printf("The minimum value is %d at position (%d, %d)\n", my->min.value, my->min.row, my->min.col);
+        printf("Mean %.6f, variance %.6f, standard deviation %.6f\n", my->mean, variance, sqrt(variance));
+        printf("Quantiles%s: P1 %.1f  P5 %.1f  P25 %.1f  P50 %.1f  P75 %.1f  P95 %.1f  P99 %.1f\n",
+               (binWidth == 1) ? "" : " (interpolated)",
+               quantile(my, 0.01), quantile(my, 0.05), quantile(my, 0.25), quantile(my, 0.50),
+               quantile(my, 0.75), quantile(my, 0.95), quantile(my, 0.99));
+
+        /* the histogram, folded into ten ranges */
+        printf("Histogram (%d bins of width %d):\n", numBins, binWidth);
+        for (int r = 0; r < 10 && r < numBins; r++) {
+            int first = (int)((long long)numBins * r / 10);
+            int last = (int)((long long)numBins * (r + 1) / 10);
+            uint64_t inRange = 0;
+            for (int k = first; k < last; k++) inRange += my->histogram[k];
+            if (last > first) {
+                int top = (last * binWidth < maxValue) ? last * binWidth - 1 : maxValue - 1;
+                printf("  [%d, %d]: %llu\n", first * binWidth, top, (unsigned long long)inRange);
+            }
+        }
+        printf("Histogram complete? %s\n", counted == (uint64_t)size * size ? "True" : "False");
+        printf("Execution time: %g sec\n", end_time - start_time);
+    }
+
+    return NULL;
+}
+
+/* Timer Function */
+double read_timer() {
+    static struct timeval start;
+    static int initialized = 0;
+    struct timeval end;
+
+    if (!initialized) {
+        gettimeofday(&start, NULL);
+        initialized = 1;
+    }
+
+    gettimeofday(&end, NULL);
+    return (end.tv_sec - start.tv_sec) + 1.0e-6 * (end.tv_usec - start.tv_usec);
+}
+
+/* Initialize Matrix */
+void initializeMatrix(int seed) {
+    if (seed >= 0) {
+        srand(seed); // Use the provided seed for reproducibility
+    } else {
+        srand(time(NULL)); // Use the current time for randomness
+    }
+
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            matrix[i][j] = rand() % maxValue; /* Random values [0, maxValue - 1] */
+        }
+    }
+}
@@ -0,0 +1,270 @@
+/* streaming matrix summation using pthreads
+
+   features: the matrix is never resident. A reader thread fills a small
+             ring of row-block buffers from a binmatrix file or a pipe
+             while the workers reduce the blocks already read. Every
+             block is split into strips of rows as in matrixSum.c, and
+             each worker carries its sum/min/max/argmax across blocks,
+             so the partial results are only combined once at the end.
+             The last worker to finish a block hands its buffer back to
+             the reader. Memory use is RING_SIZE blocks.
+
+   usage under Linux:
+     gcc -O2 matrixSum.stream.c -lpthread
+     a.out file numWorkers blockRows
+     cat file | a.out - numWorkers blockRows
+*/
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "binmatrix.h"
+
+#define MAXWORKERS 10   /* maximum number of workers */
+#define RING_SIZE  4    /* blocks in flight */
+#define BLOCK_ROWS 64   /* default rows per block */
+
+/* Struct to store a matrix element's value and position */
+typedef struct {
+    long long row;
+    int col;
+    int value;
+} MatrixElement;
+
+/* Does a come before b in row-major order? */
+static bool earlier(MatrixElement a, MatrixElement b) {
+    return a.row < b.row || (a.row == b.row && a.col < b.col);
+}
+
+/* Per-worker state carried from block to block, padded to its own lines */
+typedef struct {
+    long long localSum;
+    MatrixElement localMax;
+    MatrixElement localMin;
+    char pad[64];
+} WorkerState;
+
+/* A ring slot holding one block of rows */
+typedef struct {
+    int32_t *data;
+    long long firstRow;
+    int numRows;         /* 0 marks the end of the stream */
+    bool full;
+    int finished;        /* workers done with this block */
+    int sequence;        /* which block of the stream the slot holds */
+} Block;
+
+/* Global Variables */
+Block ring[RING_SIZE];
+pthread_mutex_t ringLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t ringChanged = PTHREAD_COND_INITIALIZER;
+WorkerState states[MAXWORKERS];
+int numWorkers, blockRows;
+int inputFd;
+BinMatrixHeader header;
+bool readError = false;
+
+/* timer */
+double read_timer() {
+    static bool initialized = false;
+    static struct timeval start;
+    struct timeval end;
+    if (!initialized) {
+        gettimeofday(&start, NULL);
+        initialized = true;
+    }
+    gettimeofday(&end, NULL);
+    return (end.tv_sec - start.tv_sec) + 1.0e-6 * (end.tv_usec - start.tv_usec);
+}
+
+/* read exactly n bytes unless the stream ends first */
+size_t readFully(int fd, void *buffer, size_t n) {
+    size_t done = 0;
+    while (done < n) {
+        ssize_t got = read(fd, (char *)buffer + done, n - done);
+        if (got <= 0) break;
+        done += got;
+    }
+    return done;
+}
+
+/* Reader: fill free slots in order with the next block of rows */
+void *Reader(void *arg) {
+    (void)arg;
+    long long row = 0;
+    long long rows = header.rows;
+    size_t strideBytes = header.stride * sizeof(int32_t);
+    size_t lastRowBytes = header.cols * sizeof(int32_t);
+
+    for (int i = 0; ; i++) {
+        Block *block = &ring[i % RING_SIZE];
+        pthread_mutex_lock(&ringLock);
+        while (block->full) pthread_cond_wait(&ringChanged, &ringLock);
+        pthread_mutex_unlock(&ringLock);
+
+        int n = (rows - row < blockRows) ? (int)(rows - row) : blockRows;
+        if (n > 0) {
+            /* the final row of the file stops at cols, not at stride */
+            size_t bytes = (row + n == rows) ? (n - 1) * strideBytes + lastRowBytes : n * strideBytes;
+            if (readFully(inputFd, block->data, bytes) != bytes) {
+                readError = true;
+                n = 0;
+            }
+        }
+
+        pthread_mutex_lock(&ringLock);
+        block->firstRow = row;
+        block->numRows = n;
+        block->finished = 0;
+        block->sequence = i;
+        block->full = true;
+        pthread_cond_broadcast(&ringChanged);
+        pthread_mutex_unlock(&ringLock);
+
+        if (n == 0) return NULL;
+        row += n;
+    }
+}
+
+/* Each worker reduces its strip of every block into its carried state */
+void *Worker(void *arg) {
+    long myid = (long)arg;
+    WorkerState *state = &states[myid];
+    int cols = header.cols;
+
+    for (int i = 0; ; i++) {
+        Block *block = &ring[i % RING_SIZE];
+        pthread_mutex_lock(&ringLock);
+        while (!block->full || block->sequence != i) pthread_cond_wait(&ringChanged, &ringLock);
+        pthread_mutex_unlock(&ringLock);
+
+        int numRows = block->numRows;
+        if (numRows == 0) return NULL;
+
+        /* determine first and last rows of my strip of this block */
+        int stripSize = numRows / numWorkers;
+        int first = myid * stripSize;
+        int last = (myid == numWorkers - 1) ? numRows - 1 : first + stripSize - 1;
+
+        for (int r = first; r <= last; r++) {
+            const int32_t *row = block->data + (size_t)r * header.stride;
+            for (int j = 0; j < cols; j++) {
+                state->localSum += row[j];
+                if (row[j] > state->localMax.value) {
+                    state->localMax = (MatrixElement){ .row = block->firstRow + r, .col = j, .value = row[j] };
+                }
+                if (row[j] < state->localMin.value) {
+                    state->localMin = (MatrixElement){ .row = block->firstRow + r, .col = j, .value = row[j] };
+                }
+            }
+        }
+
+        /* the last worker out hands the buffer back to the reader */
+        pthread_mutex_lock(&ringLock);
+        if (++block->finished == numWorkers) {
+            block->full = false;
+            pthread_cond_broadcast(&ringChanged);
+        }
+        pthread_mutex_unlock(&ringLock);
+    }
+}
+
+/* read command line, open the stream, and create threads */
+int main(int argc, char *argv[]) {
+    pthread_t reader, workerid[MAXWORKERS];
+
+    if (argc < 2) {
+        printf("Usage: %s file|- numWorkers blockRows\n", argv[0]);
+        return 1;
+    }
+    numWorkers = (argc > 2) ? atoi(argv[2]) : MAXWORKERS;
+    blockRows = (argc > 3) ? atoi(argv[3]) : BLOCK_ROWS;
+    if (numWorkers > MAXWORKERS) numWorkers = MAXWORKERS;
+    if (numWorkers < 1) numWorkers = 1;
+    if (blockRows < 1) blockRows = 1;
+
+    inputFd = (argv[1][0] == '-' && argv[1][1] == '\0') ? 0 : open(argv[1], O_RDONLY);
+    if (inputFd < 0) {
+        printf("Cannot open %s\n", argv[1]);
+        return 1;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(inputFd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    /* read and check the header, then skip to the first element */
+    if (readFully(inputFd, &header, sizeof(header)) != sizeof(header) ||
+        memcmp(header.magic, BINMATRIX_MAGIC, 8) != 0 || header.endianCheck != BINMATRIX_ENDIAN ||
+        header.dtype != DTYPE_INT32 || header.stride < header.cols || header.cols > INT_MAX ||
+        header.dataOffset < sizeof(header) || header.dataOffset % BINMATRIX_ALIGN != 0 ||
+        binmatrixTooLarge(&header)) {
+        printf("%s: not a native-endian int32 binmatrix stream\n", argv[1]);
+        return 1;
+    }
+    char skip[256];
+    for (size_t left = header.dataOffset - sizeof(header); left > 0; ) {
+        size_t n = (left < sizeof(skip)) ? left : sizeof(skip);
+        if (readFully(inputFd, skip, n) != n) {
+            printf("%s: truncated header\n", argv[1]);
+            return 1;
+        }
+        left -= n;
+    }
+
+    /* allocate the ring and reset the carried state */
+    for (int b = 0; b < RING_SIZE; b++) {
+        ring[b].data = (int32_t *)malloc(sizeof(int32_t) * header.stride * blockRows);
+        if (!ring[b].data) {
+            printf("Memory allocation error!\n");
+            return 1;
+        }
+    }
+    for (int w = 0; w < numWorkers; w++) {
+        states[w].localSum = 0;
+        states[w].localMax = (MatrixElement){ .row = LLONG_MAX, .value = INT_MIN };
+        states[w].localMin = (MatrixElement){ .row = LLONG_MAX, .value = INT_MAX };
+    }
+
+    double start_time = read_timer();
+    pthread_create(&reader, NULL, Reader, NULL);
+    for (long l = 0; l < numWorkers; l++)
+        pthread_create(&workerid[l], NULL, Worker, (void *) l);
+    for (int l = 0; l < numWorkers; l++)
+        pthread_join(workerid[l], NULL);
+    pthread_join(reader, NULL);
+
+    /* combine the carried states; a worker's blocks are spread over the
+       ring, so ties on equal values go to the earlier (row, col) */
+    long long total = 0;
+    MatrixElement max = { .row = LLONG_MAX, .value = INT_MIN }, min = { .row = LLONG_MAX, .value = INT_MAX };
+    for (int w = 0; w < numWorkers; w++) {
+        MatrixElement a = states[w].localMax, b = states[w].localMin;
+        total += states[w].localSum;
+        if (a.value > max.value || (a.value == max.value && earlier(a, max))) max = a;
+        if (b.value < min.value || (b.value == min.value && earlier(b, min))) min = b;
+    }
+    double end_time = read_timer();
+
+    if (readError) {
+        printf("Input ended early; results cover the rows read\n");
+    }
+    double megabytes = (double)header.rows * header.stride * sizeof(int32_t) / 1e6;
+    printf("Matrix: %llu x %llu, %d-row blocks, ring of %d\n",
+           (unsigned long long)header.rows, (unsigned long long)header.cols, blockRows, RING_SIZE);
+    printf("The total is %lld\n", total);
+    printf("The maximum value is %d at position (%lld, %d)\n", max.value, max.row, max.col);
+    printf("The minimum value is %d at position (%lld, %d)\n", min.value, min.row, min.col);
+    printf("The execution time is %g sec (%.1f MB/s)\n", end_time - start_time,
+           megabytes / (end_time - start_time));
+
+    for (int b = 0; b < RING_SIZE; b++) free(ring[b].data);
+    return readError ? 1 : 0;
+}
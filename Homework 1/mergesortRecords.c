@@ -0,0 +1,370 @@
+/* stable parallel merge sort of key/payload records using pthreads
+
+   features: every worker sorts its own chunk with a stable bottom-up
+             merge sort, then the workers merge the chunks pairwise.
+             Each merge round splits the whole output evenly between
+             the workers by co-ranking (merge path), so all workers
+             stay busy even in the last round. One scratch buffer is
+             allocated up front and ping-ponged between rounds; the
+             workers meet at a barrier between rounds.
+             The parallel quicksort on the bare keys is kept next to
+             it for comparison.
+
+   usage under Linux:
+     gcc -O2 mergesortRecords.c -lpthread -o mergesortRecords
+     ./mergesortRecords <array_size> <num_threads> <distinct_keys>
+*/
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/time.h>  // For gettimeofday()
+
+#define DEFAULT_ARRAY_SIZE  1000000
+#define MAXTHREADS          16
+#define THRESHOLD           100000  // Switch to serial sorting for small partitions
+#define INSERTION_RUN       32      // Run length sorted by insertion sort
+
+/* A record: sort key plus the row id or payload it carries */
+typedef struct {
+    int key;
+    int payload;
+} Record;
+
+/* ------------------------------------------------------------------ */
+/* Parallel quicksort on bare keys (unstable)                         */
+/* ------------------------------------------------------------------ */
+
+/* Swap helper function */
+void swap(int *a, int *b) {
+    int temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+/* Median-of-Three Pivot Selection */
+int medianOfThree(int left, int right, int *array) {
+    int mid = left + (right - left) / 2;
+    if (array[left] > array[mid]) swap(&array[left], &array[mid]);
+    if (array[left] > array[right]) swap(&array[left], &array[right]);
+    if (array[mid] > array[right]) swap(&array[mid], &array[right]);
+    return mid;
+}
+
+/* Partition function for quicksort */
+int partition(int left, int right, int *array) {
+    int pivotIndex = medianOfThree(left, right, array);
+    swap(&array[pivotIndex], &array[right]);
+    int pivot = array[right];
+    int i = left - 1;
+
+    for (int j = left; j < right; j++) {
+        if (array[j] < pivot) {
+            i++;
+            swap(&array[i], &array[j]);
+        }
+    }
+    swap(&array[i + 1], &array[right]);
+    return i + 1;
+}
+
+/* Serial Quicksort */
+void serialQuicksort(int left, int right, int *array) {
+    if (left < right) {
+        int pivotIndex = partition(left, right, array);
+        serialQuicksort(left, pivotIndex - 1, array);
+        serialQuicksort(pivotIndex + 1, right, array);
+    }
+}
+
+/* Struct for passing data to pthread */
+typedef struct {
+    int left;
+    int right;
+    int depth;
+    int *array;
+} QuickSortTask;
+
+void *parallelQuicksortWorker(void *arg);
+
+/* Parallel Quicksort; spawns threads only while depth allows */
+void parallelQuicksort(int left, int right, int depth, int *array) {
+    if (depth > 0 && (right - left) > THRESHOLD) {
+        int pivotIndex = partition(left, right, array);
+        pthread_t leftThread;
+        QuickSortTask task = { left, pivotIndex - 1, depth - 1, array };
+        pthread_create(&leftThread, NULL, parallelQuicksortWorker, &task);
+        parallelQuicksort(pivotIndex + 1, right, depth - 1, array);
+        pthread_join(leftThread, NULL);
+    } else {
+        serialQuicksort(left, right, array);
+    }
+}
+
+void *parallelQuicksortWorker(void *arg) {
+    QuickSortTask *task = (QuickSortTask *)arg;
+    parallelQuicksort(task->left, task->right, task->depth, task->array);
+    return NULL;
+}
+
+/* Number of spawn levels needed to keep numThreads busy */
+int spawnDepth(int threads) {
+    int depth = 0;
+    while ((1 << depth) < threads) depth++;
+    return depth;
+}
+
+/* ------------------------------------------------------------------ */
+/* Stable parallel merge sort on records                              */
+/* ------------------------------------------------------------------ */
+
+pthread_mutex_t barrier = PTHREAD_MUTEX_INITIALIZER;  /* mutex lock for the barrier */
+pthread_cond_t go = PTHREAD_COND_INITIALIZER;        /* condition variable for leaving */
+int numWorkers;           /* number of workers */
+int numArrived = 0;       /* number who have arrived */
+
+/* a reusable counter barrier */
+void Barrier() {
+    pthread_mutex_lock(&barrier);
+    numArrived++;
+    if (numArrived == numWorkers) {
+        numArrived = 0;
+        pthread_cond_broadcast(&go);
+    } else {
+        pthread_cond_wait(&go, &barrier);
+    }
+    pthread_mutex_unlock(&barrier);
+}
+
+/* Stable insertion sort of a[0..n) */
+void insertionSortRecords(Record *a, int n) {
+    for (int i = 1; i < n; i++) {
+        Record temp = a[i];
+        int j = i - 1;
+        while (j >= 0 && a[j].key > temp.key) {
+            a[j + 1] = a[j];
+            j--;
+        }
+        a[j + 1] = temp;
+    }
+}
+
+/* Stable serial merge of a[0..m) and b[0..n) into dst; ties go to a */
+void mergeRecords(const Record *a, int m, const Record *b, int n, Record *dst) {
+    int i = 0, j = 0, k = 0;
+    while (i < m && j < n) {
+        dst[k++] = (b[j].key < a[i].key) ? b[j++] : a[i++];
+    }
+    while (i < m) dst[k++] = a[i++];
+    while (j < n) dst[k++] = b[j++];
+}
+
+/* Number of elements taken from a when the first k elements of the
+   stable merge of a[0..m) and b[0..n) are output */
+int coRankRecords(int k, const Record *a, int m, const Record *b, int n) {
+    int lo = (k > n) ? k - n : 0;
+    int hi = (k < m) ? k : m;
+
+    while (1) {
+        int i = lo + (hi - lo) / 2;
+        int j = k - i;
+        if (i < m && j > 0 && b[j - 1].key >= a[i].key) {
+            lo = i + 1;
+        } else if (i > 0 && j < n && a[i - 1].key > b[j].key) {
+            hi = i - 1;
+        } else {
+            return i;
+        }
+    }
+}
+
+/* Stable bottom-up merge sort of array[0..n) using scratch[0..n);
+   the result is left in array */
+void serialMergesort(Record *array, Record *scratch, int n) {
+    Record *src = array, *dst = scratch;
+
+    for (int i = 0; i < n; i += INSERTION_RUN) {
+        insertionSortRecords(array + i, (n - i < INSERTION_RUN) ? n - i : INSERTION_RUN);
+    }
+    for (int width = INSERTION_RUN; width < n; width *= 2) {
+        for (int lo = 0; lo < n; lo += 2 * width) {
+            int mid = (lo + width < n) ? lo + width : n;
+            int hi = (lo + 2 * width < n) ? lo + 2 * width : n;
+            mergeRecords(src + lo, mid - lo, src + mid, hi - mid, dst + lo);
+        }
+        Record *temp = src;
+        src = dst;
+        dst = temp;
+    }
+    if (src != array) {
+        memcpy(array, src, sizeof(Record) * n);
+    }
+}
+
+/* Shared state of one parallel merge sort */
+Record *sortArray;        /* records being sorted */
+Record *sortScratch;      /* scratch buffer of the same size */
+int sortSize;             /* number of records */
+
+/* First element of chunk c when the array is split into numWorkers chunks */
+int chunkStart(int c) {
+    return (int)((long)sortSize * c / numWorkers);
+}
+
+/* Each worker sorts its chunk, then merges its slice of the output in
+   every round. In round r runs of 2^r chunks are merged pairwise. */
+void *MergeWorker(void *arg) {
+    long myid = (long)arg;
+    int first = chunkStart(myid);
+    int last = chunkStart(myid + 1);
+    Record *src = sortArray, *dst = sortScratch;
+
+    serialMergesort(sortArray + first, sortScratch + first, last - first);
+    Barrier();
+
+    for (int runChunks = 1; runChunks < numWorkers; runChunks *= 2) {
+        /* merge every pair of runs that overlaps my output slice */
+        for (int c = 0; c < numWorkers; c += 2 * runChunks) {
+            int lo = chunkStart(c);
+            int mid = chunkStart((c + runChunks < numWorkers) ? c + runChunks : numWorkers);
+            int hi = chunkStart((c + 2 * runChunks < numWorkers) ? c + 2 * runChunks : numWorkers);
+            if (hi <= first || lo >= last) continue;
+
+            int k0 = ((first > lo) ? first : lo) - lo;
+            int k1 = ((last < hi) ? last : hi) - lo;
+            int i0 = coRankRecords(k0, src + lo, mid - lo, src + mid, hi - mid);
+            int i1 = coRankRecords(k1, src + lo, mid - lo, src + mid, hi - mid);
+            mergeRecords(src + lo + i0, i1 - i0,
+                         src + mid + (k0 - i0), (k1 - i1) - (k0 - i0),
+                         dst + lo + k0);
+        }
+        Record *temp = src;
+        src = dst;
+        dst = temp;
+        Barrier();
+    }
+
+    /* copy my slice back if the last round ended in the scratch buffer */
+    if (src != sortArray) {
+        memcpy(sortArray + first, src + first, sizeof(Record) * (last - first));
+    }
+    return NULL;
+}
+
+/* Stable parallel merge sort of array[0..size); false, with array
+   untouched, if the scratch buffer cannot be allocated */
+bool parallelMergesort(Record *array, int size, int threads) {
+    pthread_t workers[MAXTHREADS];
+
+    sortArray = array;
+    sortSize = size;
+    sortScratch = (Record *)malloc(sizeof(Record) * (size > 0 ? size : 1));
+    if (!sortScratch) return false;
+    numWorkers = (threads < size) ? threads : (size > 0 ? size : 1);
+
+    for (long t = 0; t < numWorkers; t++) {
+        pthread_create(&workers[t], NULL, MergeWorker, (void *)t);
+    }
+    for (long t = 0; t < numWorkers; t++) {
+        pthread_join(workers[t], NULL);
+    }
+    free(sortScratch);
+    return true;
+}
+
+/* ------------------------------------------------------------------ */
+/* Driver                                                             */
+/* ------------------------------------------------------------------ */
+
+/* Sorted by key, and equal keys keep their original (payload) order */
+bool isStablySorted(Record *records, int size) {
+    for (int i = 1; i < size; i++) {
+        if (records[i - 1].key > records[i].key) return false;
+        if (records[i - 1].key == records[i].key &&
+            records[i - 1].payload > records[i].payload) return false;
+    }
+    return true;
+}
+
+bool keysMatch(Record *records, int *keys, int size) {
+    for (int i = 0; i < size; i++) {
+        if (records[i].key != keys[i]) return false;
+    }
+    return true;
+}
+
+double timeDiff(struct timeval start, struct timeval end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc == 1) {
+        printf("Usage: %s <array_size> <num_threads> <distinct_keys>\n", argv[0]);
+    }
+
+    int arraySize    = (argc > 1) ? atoi(argv[1]) : DEFAULT_ARRAY_SIZE;
+    int numThreads   = (argc > 2) ? atoi(argv[2]) : 4;
+    int distinctKeys = (argc > 3) ? atoi(argv[3]) : arraySize / 10 + 1;
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > MAXTHREADS) numThreads = MAXTHREADS;
+    if (distinctKeys < 1) distinctKeys = 1;
+
+    // Allocate and initialize the arrays
+    int *keys          = (int *)malloc(sizeof(int) * arraySize);
+    Record *records    = (Record *)malloc(sizeof(Record) * arraySize);
+    Record *serialRecs = (Record *)malloc(sizeof(Record) * arraySize);
+    if (!keys || !records || !serialRecs) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+
+    srand(42);
+    for (int i = 0; i < arraySize; i++) {
+        keys[i] = rand() % distinctKeys;
+        records[i] = (Record){ .key = keys[i], .payload = i };
+        serialRecs[i] = records[i];
+    }
+
+    struct timeval start, end;
+
+    // Measure parallel quicksort on the bare keys
+    gettimeofday(&start, NULL);
+    parallelQuicksort(0, arraySize - 1, spawnDepth(numThreads), keys);
+    gettimeofday(&end, NULL);
+    double quickTime = timeDiff(start, end);
+
+    // Measure the merge sort on one thread
+    gettimeofday(&start, NULL);
+    bool sorted = parallelMergesort(serialRecs, arraySize, 1);
+    gettimeofday(&end, NULL);
+    double serialTime = timeDiff(start, end);
+
+    // Measure the parallel merge sort
+    gettimeofday(&start, NULL);
+    sorted = parallelMergesort(records, arraySize, numThreads) && sorted;
+    gettimeofday(&end, NULL);
+    double mergeTime = timeDiff(start, end);
+    if (!sorted) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+
+    // Output results
+    printf("Array Size         : %d\n", arraySize);
+    printf("Distinct Keys      : %d\n", distinctKeys);
+    printf("Quicksort Time     : %f seconds (keys only, unstable)\n", quickTime);
+    printf("Serial Time        : %f seconds\n", serialTime);
+    printf("Parallel Time      : %f seconds\n", mergeTime);
+    printf("Stable?            : %s\n",
+           (isStablySorted(records, arraySize) && isStablySorted(serialRecs, arraySize)) ? "True" : "False");
+    printf("Array Equality?    : %s\n", keysMatch(records, keys, arraySize) ? "True" : "False");
+
+    free(keys);
+    free(records);
+    free(serialRecs);
+    return 0;
+}
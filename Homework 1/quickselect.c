@@ -0,0 +1,173 @@
+/* parallel selection driver: median, percentiles and top-k
+
+   features: compares a full parallel quicksort with the parallel
+             quickselect from quickselect.h for the median, several
+             percentiles in one pass and the top-k elements, and checks
+             the answers against the sorted array.
+
+   usage under Linux:
+     gcc -O2 quickselect.c -lpthread -o quickselect
+     ./quickselect <array_size> <num_threads> <k>
+*/
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/time.h>  // For gettimeofday()
+#include "quickselect.h"
+
+#define DEFAULT_ARRAY_SIZE 1000000
+#define THRESHOLD          100000  // Switch to serial sorting for small partitions
+
+/* Serial Quicksort */
+void serialQuicksort(int left, int right, int *array) {
+    if (left < right) {
+        int pivotIndex = partition(left, right, array);
+        serialQuicksort(left, pivotIndex - 1, array);
+        serialQuicksort(pivotIndex + 1, right, array);
+    }
+}
+
+/* Struct for passing data to pthread */
+typedef struct {
+    int left;
+    int right;
+    int depth;
+    int *array;
+} QuickSortTask;
+
+void *parallelQuicksortWorker(void *arg);
+
+/* Parallel Quicksort; spawns threads only while depth allows */
+void parallelQuicksort(int left, int right, int depth, int *array) {
+    if (depth > 0 && (right - left) > THRESHOLD) {
+        int pivotIndex = partition(left, right, array);
+        pthread_t leftThread;
+        QuickSortTask task = { left, pivotIndex - 1, depth - 1, array };
+        pthread_create(&leftThread, NULL, parallelQuicksortWorker, &task);
+        parallelQuicksort(pivotIndex + 1, right, depth - 1, array);
+        pthread_join(leftThread, NULL);
+    } else {
+        serialQuicksort(left, right, array);
+    }
+}
+
+void *parallelQuicksortWorker(void *arg) {
+    QuickSortTask *task = (QuickSortTask *)arg;
+    parallelQuicksort(task->left, task->right, task->depth, task->array);
+    return NULL;
+}
+
+/* Number of spawn levels needed to keep numThreads busy */
+int spawnDepth(int threads) {
+    int depth = 0;
+    while ((1 << depth) < threads) depth++;
+    return depth;
+}
+
+double timeDiff(struct timeval start, struct timeval end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc == 1) {
+        printf("Usage: %s <array_size> <num_threads> <k>\n", argv[0]);
+    }
+
+    int arraySize  = (argc > 1) ? atoi(argv[1]) : DEFAULT_ARRAY_SIZE;
+    int numThreads = (argc > 2) ? atoi(argv[2]) : 4;
+    int k          = (argc > 3) ? atoi(argv[3]) : 10;
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > SELECT_MAXTHREADS) numThreads = SELECT_MAXTHREADS;
+    if (arraySize < 1) arraySize = 1;
+    if (k > arraySize) k = arraySize;
+
+    const double pcts[] = { 1, 10, 25, 50, 75, 90, 99 };
+    const int numPcts = sizeof(pcts) / sizeof(pcts[0]);
+    int ranks[sizeof(pcts) / sizeof(pcts[0])];
+    int answers[sizeof(pcts) / sizeof(pcts[0])];
+
+    // Allocate and initialize the arrays
+    int *original = (int *)malloc(sizeof(int) * arraySize);
+    int *sorted   = (int *)malloc(sizeof(int) * arraySize);
+    int *work     = (int *)malloc(sizeof(int) * arraySize);
+    int *top      = (int *)malloc(sizeof(int) * (k > 0 ? k : 1));
+    if (!original || !sorted || !work || !top) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+
+    srand(42);
+    for (int i = 0; i < arraySize; i++) {
+        original[i] = rand() % (arraySize * 10);
+    }
+    memcpy(sorted, original, sizeof(int) * arraySize);
+    for (int p = 0; p < numPcts; p++) {
+        ranks[p] = percentileRank(pcts[p], arraySize);
+    }
+
+    struct timeval start, end;
+
+    // Measure the full parallel sort
+    gettimeofday(&start, NULL);
+    parallelQuicksort(0, arraySize - 1, spawnDepth(numThreads), sorted);
+    gettimeofday(&end, NULL);
+    double sortTime = timeDiff(start, end);
+
+    // Measure the median by selection
+    memcpy(work, original, sizeof(int) * arraySize);
+    gettimeofday(&start, NULL);
+    int median;
+    bool selected = parallelNthElement(work, arraySize, arraySize / 2, &median, numThreads);
+    gettimeofday(&end, NULL);
+    double medianTime = timeDiff(start, end);
+
+    // Measure all percentiles in one pass
+    memcpy(work, original, sizeof(int) * arraySize);
+    gettimeofday(&start, NULL);
+    selected = parallelMultiSelect(work, arraySize, ranks, numPcts, answers, numThreads) && selected;
+    gettimeofday(&end, NULL);
+    double percentileTime = timeDiff(start, end);
+
+    // Measure top-k
+    gettimeofday(&start, NULL);
+    int found = parallelTopK(original, arraySize, k, top, numThreads);
+    gettimeofday(&end, NULL);
+    double topKTime = timeDiff(start, end);
+    if (!selected || found < 0) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+
+    // Check every answer against the sorted array
+    bool correct = (median == sorted[arraySize / 2]);
+    for (int p = 0; p < numPcts; p++) {
+        correct = correct && (answers[p] == sorted[ranks[p]]);
+    }
+    for (int i = 0; i < found; i++) {
+        correct = correct && (top[i] == sorted[arraySize - 1 - i]);
+    }
+
+    // Output results
+    printf("Array Size         : %d\n", arraySize);
+    printf("Full Sort Time     : %f seconds\n", sortTime);
+    printf("Median Time        : %f seconds\n", medianTime);
+    printf("Percentile Time    : %f seconds (%d percentiles)\n", percentileTime, numPcts);
+    printf("Top-%d Time        : %f seconds\n", k, topKTime);
+    printf("Median             : %d\n", median);
+    for (int p = 0; p < numPcts; p++) {
+        printf("P%-2g               : %d\n", pcts[p], answers[p]);
+    }
+    printf("Largest            : %d\n", found > 0 ? top[0] : 0);
+    printf("Correct?           : %s\n", correct ? "True" : "False");
+
+    free(original);
+    free(sorted);
+    free(work);
+    free(top);
+    return 0;
+}
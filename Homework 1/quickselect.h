@@ -0,0 +1,356 @@
+/* parallel selection using pthreads: nth element, percentiles and top-k
+
+   features: quickselect with a medianOfThree pivot. Ranges larger than
+             SELECT_PARALLEL are split three ways (<, ==, > pivot) by
+             numThreads workers that count their chunk, prefix-sum the
+             counts and scatter into a scratch buffer; the buffers are
+             ping-ponged, and only the pieces that end up in the scratch
+             are copied back, so the array stays a permutation of its
+             input. Small ranges use the serial partition. Several
+             ranks are resolved in one pass by sending each rank down
+             the side that holds it.
+             Top-k keeps a bounded min-heap per worker and merges them.
+
+   Include in a program that is linked with -lpthread.
+*/
+#ifndef QUICKSELECT_H
+#define QUICKSELECT_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define SELECT_MAXTHREADS 16
+#define SELECT_PARALLEL   100000  /* Split larger ranges between threads */
+#define SELECT_SERIAL     4096    /* Use the serial partition below this */
+
+/* Swap helper function */
+static inline void swap(int *a, int *b) {
+    int temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+/* Median-of-Three Pivot Selection */
+static inline int medianOfThree(int left, int right, int *array) {
+    int mid = left + (right - left) / 2;
+    if (array[left] > array[mid]) swap(&array[left], &array[mid]);
+    if (array[left] > array[right]) swap(&array[left], &array[right]);
+    if (array[mid] > array[right]) swap(&array[mid], &array[right]);
+    return mid;
+}
+
+/* Partition function for quicksort */
+static inline int partition(int left, int right, int *array) {
+    int pivotIndex = medianOfThree(left, right, array);
+    swap(&array[pivotIndex], &array[right]);
+    int pivot = array[right];
+    int i = left - 1;
+
+    for (int j = left; j < right; j++) {
+        if (array[j] < pivot) {
+            i++;
+            swap(&array[i], &array[j]);
+        }
+    }
+    swap(&array[i + 1], &array[right]);
+    return i + 1;
+}
+
+/* ------------------------------------------------------------------ */
+/* Three-way partition into a second buffer                           */
+/* ------------------------------------------------------------------ */
+
+/* Struct for passing one chunk of a three-way partition to a thread */
+typedef struct {
+    const int *src;
+    int *dst;
+    int first, last;          /* chunk [first, last) of src */
+    int pivot;
+    int numLess, numEqual;    /* counts of the chunk */
+    int lessAt, equalAt, greaterAt;  /* where the chunk writes in dst */
+} SplitTask;
+
+static inline void *splitCountWorker(void *arg) {
+    SplitTask *task = (SplitTask *)arg;
+    int less = 0, equal = 0;
+    for (int i = task->first; i < task->last; i++) {
+        less += task->src[i] < task->pivot;
+        equal += task->src[i] == task->pivot;
+    }
+    task->numLess = less;
+    task->numEqual = equal;
+    return NULL;
+}
+
+static inline void *splitScatterWorker(void *arg) {
+    SplitTask *task = (SplitTask *)arg;
+    int l = task->lessAt, e = task->equalAt, g = task->greaterAt;
+    for (int i = task->first; i < task->last; i++) {
+        int v = task->src[i];
+        if (v < task->pivot) task->dst[l++] = v;
+        else if (v == task->pivot) task->dst[e++] = v;
+        else task->dst[g++] = v;
+    }
+    return NULL;
+}
+
+/* Copy src[lo, hi) to dst[lo, hi) split into <, == and > pivot.
+   Uses up to threads workers; returns the two counts. */
+static inline void splitThreeWays(const int *src, int *dst, int lo, int hi, int pivot,
+                                  int threads, int *numLess, int *numEqual) {
+    pthread_t workers[SELECT_MAXTHREADS];
+    SplitTask tasks[SELECT_MAXTHREADS];
+    int size = hi - lo;
+
+    if (size < SELECT_PARALLEL) threads = 1;
+    for (int t = 0; t < threads; t++) {
+        tasks[t].src = src;
+        tasks[t].dst = dst;
+        tasks[t].first = lo + (int)((long)size * t / threads);
+        tasks[t].last = lo + (int)((long)size * (t + 1) / threads);
+        tasks[t].pivot = pivot;
+    }
+
+    if (threads == 1) {
+        splitCountWorker(&tasks[0]);
+    } else {
+        for (int t = 0; t < threads; t++) pthread_create(&workers[t], NULL, splitCountWorker, &tasks[t]);
+        for (int t = 0; t < threads; t++) pthread_join(workers[t], NULL);
+    }
+
+    /* prefix sums of the counts give every chunk its output slots */
+    int less = 0, equal = 0;
+    for (int t = 0; t < threads; t++) {
+        less += tasks[t].numLess;
+        equal += tasks[t].numEqual;
+    }
+    int l = lo, e = lo + less, g = lo + less + equal;
+    for (int t = 0; t < threads; t++) {
+        tasks[t].lessAt = l;
+        tasks[t].equalAt = e;
+        tasks[t].greaterAt = g;
+        l += tasks[t].numLess;
+        e += tasks[t].numEqual;
+        g += (tasks[t].last - tasks[t].first) - tasks[t].numLess - tasks[t].numEqual;
+    }
+
+    if (threads == 1) {
+        splitScatterWorker(&tasks[0]);
+    } else {
+        for (int t = 0; t < threads; t++) pthread_create(&workers[t], NULL, splitScatterWorker, &tasks[t]);
+        for (int t = 0; t < threads; t++) pthread_join(workers[t], NULL);
+    }
+
+    *numLess = less;
+    *numEqual = equal;
+}
+
+/* ------------------------------------------------------------------ */
+/* Selection                                                          */
+/* ------------------------------------------------------------------ */
+
+/* Resolve the sorted ranks ks[0..nk) that fall in array[lo, hi) with
+   the serial partition; results go to out[0..nk) */
+static inline void serialMultiSelect(int *array, int lo, int hi, const int *ks, int nk, int *out) {
+    while (nk > 0 && hi - lo > 1) {
+        int p = partition(lo, hi - 1, array);
+        int left = 0, right = nk;
+        while (left < nk && ks[left] < p) left++;
+        right = left;
+        while (right < nk && ks[right] == p) out[right++] = array[p];
+        serialMultiSelect(array, lo, p, ks, left, out);
+        ks += right;
+        out += right;
+        nk -= right;
+        lo = p + 1;
+    }
+    for (int r = 0; r < nk; r++) out[r] = array[lo];
+}
+
+/* Copy src[lo, hi) home unless it is already there */
+static inline void settleRange(const int *src, int *home, int lo, int hi) {
+    if (src != home && hi > lo) memcpy(home + lo, src + lo, sizeof(int) * (hi - lo));
+}
+
+/* Resolve the sorted ranks ks[0..nk) in src[lo, hi); dst is scratch.
+   Every piece finished with is settled in home, the caller's array. */
+static inline void multiSelectRange(int *src, int *dst, int *home, int lo, int hi, const int *ks,
+                                    int nk, int *out, int threads) {
+    while (nk > 0 && hi - lo > SELECT_SERIAL) {
+        int pivot = src[medianOfThree(lo, hi - 1, src)];
+        int numLess, numEqual;
+        splitThreeWays(src, dst, lo, hi, pivot, threads, &numLess, &numEqual);
+
+        int lessEnd = lo + numLess, equalEnd = lessEnd + numEqual;
+        int left = 0, right;
+        while (left < nk && ks[left] < lessEnd) left++;
+        right = left;
+        while (right < nk && ks[right] < equalEnd) out[right++] = pivot;
+
+        /* the data now lives in dst; src becomes the scratch */
+        multiSelectRange(dst, src, home, lo, lessEnd, ks, left, out, threads);
+        settleRange(dst, home, lessEnd, equalEnd);
+        int *temp = src;
+        src = dst;
+        dst = temp;
+        ks += right;
+        out += right;
+        nk -= right;
+        lo = equalEnd;
+    }
+    if (nk > 0) serialMultiSelect(src, lo, hi, ks, nk, out);
+    settleRange(src, home, lo, hi);
+}
+
+static inline int compareInts(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/* Order statistics: out[i] is the ks[i]-th smallest (0-based) element of
+   array[0, size). The ranks may be in any order. array is reordered.
+   Returns false, leaving array and out alone, if a rank is outside
+   [0, size) or memory runs out. */
+static inline bool parallelMultiSelect(int *array, int size, const int *ks, int nk, int *out,
+                                       int threads) {
+    for (int i = 0; i < nk; i++) {
+        if (ks[i] < 0 || ks[i] >= size) return false;
+    }
+    if (nk <= 0) return true;
+
+    int *sortedKs = (int *)malloc(sizeof(int) * nk);
+    int *sortedOut = (int *)malloc(sizeof(int) * nk);
+    int *scratch = (int *)malloc(sizeof(int) * size);
+    if (!sortedKs || !sortedOut || !scratch) {
+        free(sortedKs);
+        free(sortedOut);
+        free(scratch);
+        return false;
+    }
+
+    if (threads < 1) threads = 1;
+    if (threads > SELECT_MAXTHREADS) threads = SELECT_MAXTHREADS;
+    memcpy(sortedKs, ks, sizeof(int) * nk);
+    qsort(sortedKs, nk, sizeof(int), compareInts);
+    multiSelectRange(array, scratch, array, 0, size, sortedKs, nk, sortedOut, threads);
+
+    /* hand the answers back in the caller's rank order */
+    for (int i = 0; i < nk; i++) {
+        int r = 0;
+        while (sortedKs[r] != ks[i]) r++;
+        out[i] = sortedOut[r];
+    }
+
+    free(sortedKs);
+    free(sortedOut);
+    free(scratch);
+    return true;
+}
+
+/* The k-th smallest (0-based) element of array[0, size) into *result;
+   array is reordered. False as for parallelMultiSelect. */
+static inline bool parallelNthElement(int *array, int size, int k, int *result, int threads) {
+    return parallelMultiSelect(array, size, &k, 1, result, threads);
+}
+
+/* Rank of percentile pct (0..100) in an array of size elements */
+static inline int percentileRank(double pct, int size) {
+    int k = (int)(pct / 100.0 * (size - 1) + 0.5);
+    return (k < 0) ? 0 : (k >= size ? size - 1 : k);
+}
+
+/* ------------------------------------------------------------------ */
+/* Top-k                                                              */
+/* ------------------------------------------------------------------ */
+
+/* Restore the min-heap property below position i */
+static inline void heapSiftDown(int *heap, int n, int i) {
+    while (1) {
+        int smallest = i, l = 2 * i + 1, r = 2 * i + 2;
+        if (l < n && heap[l] < heap[smallest]) smallest = l;
+        if (r < n && heap[r] < heap[smallest]) smallest = r;
+        if (smallest == i) return;
+        swap(&heap[i], &heap[smallest]);
+        i = smallest;
+    }
+}
+
+/* Offer v to a bounded min-heap holding the largest values seen */
+static inline void heapOffer(int *heap, int *n, int k, int v) {
+    if (*n < k) {
+        int i = (*n)++;
+        heap[i] = v;
+        while (i > 0 && heap[(i - 1) / 2] > heap[i]) {
+            swap(&heap[i], &heap[(i - 1) / 2]);
+            i = (i - 1) / 2;
+        }
+    } else if (v > heap[0]) {
+        heap[0] = v;
+        heapSiftDown(heap, k, 0);
+    }
+}
+
+/* Struct for passing one chunk of a top-k scan to a thread */
+typedef struct {
+    const int *array;
+    int first, last;
+    int k;
+    int *heap;
+    int heapSize;
+} TopKTask;
+
+static inline void *topKWorker(void *arg) {
+    TopKTask *task = (TopKTask *)arg;
+    task->heapSize = 0;
+    for (int i = task->first; i < task->last; i++) {
+        heapOffer(task->heap, &task->heapSize, task->k, task->array[i]);
+    }
+    return NULL;
+}
+
+/* The k largest elements of array[0, size) in descending order;
+   returns how many were written to out (min(k, size)), or -1 if the
+   per-thread heaps cannot be allocated */
+static inline int parallelTopK(const int *array, int size, int k, int *out, int threads) {
+    pthread_t workers[SELECT_MAXTHREADS];
+    TopKTask tasks[SELECT_MAXTHREADS];
+    int n = 0;
+
+    if (k > size) k = size;
+    if (k <= 0) return 0;
+    if (threads < 1) threads = 1;
+    if (threads > SELECT_MAXTHREADS) threads = SELECT_MAXTHREADS;
+
+    bool allocated = true;
+    for (int t = 0; t < threads; t++) {
+        tasks[t] = (TopKTask){ array, (int)((long)size * t / threads),
+                               (int)((long)size * (t + 1) / threads), k,
+                               (int *)malloc(sizeof(int) * k), 0 };
+        allocated = allocated && tasks[t].heap;
+    }
+    if (!allocated) {
+        for (int t = 0; t < threads; t++) free(tasks[t].heap);
+        return -1;
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_create(&workers[t], NULL, topKWorker, &tasks[t]);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+
+    /* merge the per-thread heaps into out, then pop them largest last */
+    for (int t = 0; t < threads; t++) {
+        for (int i = 0; i < tasks[t].heapSize; i++) heapOffer(out, &n, k, tasks[t].heap[i]);
+        free(tasks[t].heap);
+    }
+    for (int end = n - 1; end > 0; end--) {
+        swap(&out[0], &out[end]);
+        heapSiftDown(out, end, 0);
+    }
+    return n;
+}
+
+#endif /* QUICKSELECT_H */
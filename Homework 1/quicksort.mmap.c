@@ -0,0 +1,191 @@
+/* parallel quicksort of a memory-mapped binmatrix file using pthreads
+
+   features: the input file is mapped read-only and the output file is
+             created in the same format and mapped writable. The
+             elements are copied straight from one mapping to the other
+             (dropping any row padding) and sorted in place there, so
+             the sorted result lands in the output file without any
+             read/write calls or extra buffers.
+
+   usage under Linux:
+     gcc -O2 quicksort.mmap.c -lpthread -o quicksort.mmap
+     ./quicksort.mmap <input> <output> <num_threads>
+*/
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/time.h>  // For gettimeofday()
+#include "binmatrix.h"
+
+#define MAXTHREADS 16
+#define THRESHOLD  100000  // Switch to serial sorting for small partitions
+
+/* Swap helper function */
+void swap(int *a, int *b) {
+    int temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+/* Median-of-Three Pivot Selection */
+int medianOfThree(int left, int right, int *array) {
+    int mid = left + (right - left) / 2;
+    if (array[left] > array[mid]) swap(&array[left], &array[mid]);
+    if (array[left] > array[right]) swap(&array[left], &array[right]);
+    if (array[mid] > array[right]) swap(&array[mid], &array[right]);
+    return mid;
+}
+
+/* Partition function for quicksort */
+int partition(int left, int right, int *array) {
+    int pivotIndex = medianOfThree(left, right, array);
+    swap(&array[pivotIndex], &array[right]);
+    int pivot = array[right];
+    int i = left - 1;
+
+    for (int j = left; j < right; j++) {
+        if (array[j] < pivot) {
+            i++;
+            swap(&array[i], &array[j]);
+        }
+    }
+    swap(&array[i + 1], &array[right]);
+    return i + 1;
+}
+
+/* Serial Quicksort */
+void serialQuicksort(int left, int right, int *array) {
+    if (left < right) {
+        int pivotIndex = partition(left, right, array);
+        serialQuicksort(left, pivotIndex - 1, array);
+        serialQuicksort(pivotIndex + 1, right, array);
+    }
+}
+
+/* Struct for passing data to pthread */
+typedef struct {
+    int left;
+    int right;
+    int depth;
+    int *array;
+} QuickSortTask;
+
+void *parallelQuicksortWorker(void *arg);
+
+/* Parallel Quicksort; spawns threads only while depth allows */
+void parallelQuicksort(int left, int right, int depth, int *array) {
+    if (depth > 0 && (right - left) > THRESHOLD) {
+        int pivotIndex = partition(left, right, array);
+        pthread_t leftThread;
+        QuickSortTask task = { left, pivotIndex - 1, depth - 1, array };
+        pthread_create(&leftThread, NULL, parallelQuicksortWorker, &task);
+        parallelQuicksort(pivotIndex + 1, right, depth - 1, array);
+        pthread_join(leftThread, NULL);
+    } else {
+        serialQuicksort(left, right, array);
+    }
+}
+
+void *parallelQuicksortWorker(void *arg) {
+    QuickSortTask *task = (QuickSortTask *)arg;
+    parallelQuicksort(task->left, task->right, task->depth, task->array);
+    return NULL;
+}
+
+/* Number of spawn levels needed to keep numThreads busy */
+int spawnDepth(int threads) {
+    int depth = 0;
+    while ((1 << depth) < threads) depth++;
+    return depth;
+}
+
+/* Struct for passing a band of rows to a copy thread */
+typedef struct {
+    const BinMatrix *in;
+    int *out;
+    uint64_t firstRow, lastRow;  /* rows [firstRow, lastRow) */
+} CopyTask;
+
+/* Copy a band of input rows into the packed output */
+void *copyWorker(void *arg) {
+    CopyTask *task = (CopyTask *)arg;
+    uint64_t cols = task->in->header.cols;
+    for (uint64_t r = task->firstRow; r < task->lastRow; r++) {
+        memcpy(task->out + r * cols, binmatrixRow(task->in, r), sizeof(int) * cols);
+    }
+    return NULL;
+}
+
+double timeDiff(struct timeval start, struct timeval end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        printf("Usage: %s <input> <output> <num_threads>\n", argv[0]);
+        return 1;
+    }
+
+    int numThreads = (argc > 3) ? atoi(argv[3]) : 4;
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > MAXTHREADS) numThreads = MAXTHREADS;
+
+    BinMatrix in, out;
+    if (binmatrixOpen(argv[1], BINMATRIX_SEQUENTIAL, &in) < 0) {
+        return 1;
+    }
+    uint64_t count = in.header.rows * in.header.cols;
+    if (in.header.dtype != DTYPE_INT32 || count > INT_MAX) {
+        printf("Only int32 inputs of up to INT_MAX elements are supported\n");
+        return 1;
+    }
+    if (binmatrixCreate(argv[2], DTYPE_INT32, in.header.rows, in.header.cols, in.header.cols, &out) < 0) {
+        return 1;
+    }
+    int *array = (int *)out.data;
+
+    struct timeval start, middle, end;
+    pthread_t workers[MAXTHREADS];
+    CopyTask tasks[MAXTHREADS];
+
+    // Copy from the input mapping into the output mapping
+    gettimeofday(&start, NULL);
+    for (int t = 0; t < numThreads; t++) {
+        tasks[t] = (CopyTask){ &in, array, in.header.rows * t / numThreads,
+                               in.header.rows * (t + 1) / numThreads };
+        pthread_create(&workers[t], NULL, copyWorker, &tasks[t]);
+    }
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+    gettimeofday(&middle, NULL);
+
+    // Sort in place inside the output file
+    parallelQuicksort(0, (int)count - 1, spawnDepth(numThreads), array);
+    gettimeofday(&end, NULL);
+
+    bool sorted = true;
+    for (uint64_t i = 1; i < count; i++) {
+        if (array[i - 1] > array[i]) {
+            sorted = false;
+            break;
+        }
+    }
+
+    // Output results
+    printf("Array Size         : %llu\n", (unsigned long long)count);
+    printf("Copy Time          : %f seconds\n", timeDiff(start, middle));
+    printf("Parallel Time      : %f seconds\n", timeDiff(middle, end));
+    printf("Sorted?            : %s\n", sorted ? "True" : "False");
+
+    binmatrixClose(&in);
+    binmatrixClose(&out);
+    return 0;
+}
@@ -0,0 +1,438 @@
+/* parallel text ingestion and quicksort of newline-separated integers
+
+   features: the text file is mapped with mmap and split into one chunk
+             per thread at newline boundaries. A first parallel pass
+             counts the lines of each chunk; a prefix sum over the counts
+             gives every chunk its offset in the sort buffer, and the
+             second pass parses straight into place. Eight digits at a
+             time are converted with SWAR arithmetic on a 64-bit word.
+             Malformed lines leave a hole that is squeezed out afterwards
+             only if there were any, so the fast path never branches on
+             error bookkeeping beyond the per-line check.
+
+   usage under Linux:
+     gcc -O2 quicksort.text.c -lpthread -o quicksort.text
+     ./quicksort.text --generate <file> <count> <seed>
+     ./quicksort.text <file> <num_threads>
+*/
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>  // For gettimeofday()
+
+#define MAXTHREADS    16
+#define THRESHOLD     100000  // Switch to serial sorting for small partitions
+#define MAX_REPORTED  5       // Malformed line numbers remembered per thread
+
+/* Swap helper function */
+void swap(int *a, int *b) {
+    int temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+/* Median-of-Three Pivot Selection */
+int medianOfThree(int left, int right, int *array) {
+    int mid = left + (right - left) / 2;
+    if (array[left] > array[mid]) swap(&array[left], &array[mid]);
+    if (array[left] > array[right]) swap(&array[left], &array[right]);
+    if (array[mid] > array[right]) swap(&array[mid], &array[right]);
+    return mid;
+}
+
+/* Partition function for quicksort */
+int partition(int left, int right, int *array) {
+    int pivotIndex = medianOfThree(left, right, array);
+    swap(&array[pivotIndex], &array[right]);
+    int pivot = array[right];
+    int i = left - 1;
+
+    for (int j = left; j < right; j++) {
+        if (array[j] < pivot) {
+            i++;
+            swap(&array[i], &array[j]);
+        }
+    }
+    swap(&array[i + 1], &array[right]);
+    return i + 1;
+}
+
+/* Serial Quicksort */
+void serialQuicksort(int left, int right, int *array) {
+    if (left < right) {
+        int pivotIndex = partition(left, right, array);
+        serialQuicksort(left, pivotIndex - 1, array);
+        serialQuicksort(pivotIndex + 1, right, array);
+    }
+}
+
+/* Struct for passing data to pthread */
+typedef struct {
+    int left;
+    int right;
+    int depth;
+    int *array;
+} QuickSortTask;
+
+void *parallelQuicksortWorker(void *arg);
+
+/* Parallel Quicksort; spawns threads only while depth allows */
+void parallelQuicksort(int left, int right, int depth, int *array) {
+    if (depth > 0 && (right - left) > THRESHOLD) {
+        int pivotIndex = partition(left, right, array);
+        pthread_t leftThread;
+        QuickSortTask task = { left, pivotIndex - 1, depth - 1, array };
+        pthread_create(&leftThread, NULL, parallelQuicksortWorker, &task);
+        parallelQuicksort(pivotIndex + 1, right, depth - 1, array);
+        pthread_join(leftThread, NULL);
+    } else {
+        serialQuicksort(left, right, array);
+    }
+}
+
+void *parallelQuicksortWorker(void *arg) {
+    QuickSortTask *task = (QuickSortTask *)arg;
+    parallelQuicksort(task->left, task->right, task->depth, task->array);
+    return NULL;
+}
+
+/* Number of spawn levels needed to keep numThreads busy */
+int spawnDepth(int threads) {
+    int depth = 0;
+    while ((1 << depth) < threads) depth++;
+    return depth;
+}
+
+/* ------------------------------------------------------------------ */
+/* Parsing                                                            */
+/* ------------------------------------------------------------------ */
+
+/* Are all eight bytes of v ASCII digits? */
+static inline bool allDigits(uint64_t v) {
+    return (((v & 0xF0F0F0F0F0F0F0F0ULL) |
+             (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+            0x3333333333333333ULL);
+}
+
+/* Value of eight ASCII digits loaded little-endian into v */
+static inline uint32_t eightDigits(uint64_t v) {
+    v -= 0x3030303030303030ULL;
+    v = (v * 10) + (v >> 8);
+    v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+         (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    return (uint32_t)v;
+}
+
+/* Parse one line starting at p. Returns the start of the next line and
+   sets *ok to whether the line held exactly one int. */
+static inline const char *parseLine(const char *p, const char *end, int *value, bool *ok) {
+    bool negative = (*p == '-');
+    const char *digits;
+    uint64_t acc = 0;
+
+    p += negative;
+    /* leading zeros do not count towards the ten digits */
+    while (p + 1 < end && *p == '0' && (unsigned)(p[1] - '0') < 10) p++;
+    digits = p;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (end - p >= 8) {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        if (allDigits(word)) {
+            acc = eightDigits(word);
+            p += 8;
+        }
+    }
+#endif
+    while (p < end && (unsigned)(*p - '0') < 10 && p - digits < 11) {
+        acc = acc * 10 + (*p - '0');
+        p++;
+    }
+
+    int count = p - digits;
+    if (p < end && *p == '\r') p++;
+    *ok = count > 0 && count <= 10 && (p == end || *p == '\n') &&
+          acc <= (negative ? (uint64_t)INT_MAX + 1 : (uint64_t)INT_MAX);
+    *value = negative ? (int)(0 - acc) : (int)acc;
+
+    if (!*ok) {
+        /* skip the rest of a malformed line */
+        const char *newline = memchr(p, '\n', end - p);
+        p = newline ? newline : end;
+    }
+    return (p < end) ? p + 1 : end;
+}
+
+/* Struct for passing one chunk of the text to a thread */
+typedef struct {
+    const char *first, *last;   /* chunk [first, last), whole lines */
+    long lines;                 /* lines in the chunk */
+    long offset;                /* first slot of the chunk in the output */
+    long firstLine;             /* line number of the chunk's first line */
+    int *out;
+    long malformed;
+    long reported[MAX_REPORTED];
+} ParseTask;
+
+/* Pass 1: count the lines of a chunk */
+void *countWorker(void *arg) {
+    ParseTask *task = (ParseTask *)arg;
+    const char *p = task->first;
+    long lines = 0;
+
+    while (p < task->last) {
+        const char *newline = memchr(p, '\n', task->last - p);
+        lines++;
+        if (!newline) break;
+        p = newline + 1;
+    }
+    task->lines = lines;
+    return NULL;
+}
+
+/* Pass 2: parse the lines of a chunk straight into their slots */
+void *parseWorker(void *arg) {
+    ParseTask *task = (ParseTask *)arg;
+    const char *p = task->first;
+    int *out = task->out + task->offset;
+    long line = 0;
+    bool ok;
+
+    task->malformed = 0;
+    while (p < task->last) {
+        p = parseLine(p, task->last, &out[line], &ok);
+        if (!ok) {
+            if (task->malformed < MAX_REPORTED) {
+                task->reported[task->malformed] = task->firstLine + line;
+            }
+            task->malformed++;
+            out[line] = INT_MIN;  /* hole, removed later */
+        }
+        line++;
+    }
+    return NULL;
+}
+
+/* Slow path: squeeze the holes left by malformed lines out of the output */
+long compact(ParseTask *tasks, int numTasks, int *out) {
+    long write = 0;
+    for (int t = 0; t < numTasks; t++) {
+        if (tasks[t].malformed == 0) {
+            memmove(out + write, out + tasks[t].offset, sizeof(int) * tasks[t].lines);
+            write += tasks[t].lines;
+            continue;
+        }
+        /* re-walk the chunk to tell holes from genuine INT_MIN values */
+        const char *p = tasks[t].first;
+        bool ok;
+        int value;
+        for (long line = 0; p < tasks[t].last; line++) {
+            p = parseLine(p, tasks[t].last, &value, &ok);
+            if (ok) out[write++] = out[tasks[t].offset + line];
+        }
+    }
+    return write;
+}
+
+/* Parse the mapped text into a freshly allocated array; NULL if it
+   cannot be allocated */
+int *parseText(const char *text, size_t size, int numThreads, long *count, long *malformed) {
+    pthread_t workers[MAXTHREADS];
+    ParseTask tasks[MAXTHREADS];
+    const char *end = text + size;
+
+    /* chunk boundaries: the byte after the first newline past each split */
+    const char *cut = text;
+    for (int t = 0; t < numThreads; t++) {
+        memset(&tasks[t], 0, sizeof(ParseTask));
+        tasks[t].first = cut;
+        if (t == numThreads - 1) {
+            cut = end;
+        } else {
+            const char *split = text + size * (t + 1) / numThreads;
+            if (split < cut) split = cut;
+            const char *newline = (split < end) ? memchr(split, '\n', end - split) : NULL;
+            cut = newline ? newline + 1 : end;
+        }
+        tasks[t].last = cut;
+        pthread_create(&workers[t], NULL, countWorker, &tasks[t]);
+    }
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+
+    /* prefix sum of the line counts */
+    long total = 0;
+    for (int t = 0; t < numThreads; t++) {
+        tasks[t].offset = total;
+        tasks[t].firstLine = total + 1;
+        total += tasks[t].lines;
+    }
+
+    int *out = (int *)malloc(sizeof(int) * (total > 0 ? total : 1));
+    if (!out) return NULL;
+    for (int t = 0; t < numThreads; t++) {
+        tasks[t].out = out;
+        pthread_create(&workers[t], NULL, parseWorker, &tasks[t]);
+    }
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+
+    *malformed = 0;
+    for (int t = 0; t < numThreads; t++) {
+        for (long r = 0; r < tasks[t].malformed && r < MAX_REPORTED; r++) {
+            printf("Malformed line %ld\n", tasks[t].reported[r]);
+        }
+        *malformed += tasks[t].malformed;
+    }
+    *count = (*malformed > 0) ? compact(tasks, numThreads, out) : total;
+    return out;
+}
+
+/* Reference: one strtol per line on a single thread */
+long parseSerial(const char *text, size_t size, int *out) {
+    const char *p = text, *end = text + size;
+    long count = 0;
+    char line[32];
+
+    while (p < end) {
+        const char *newline = memchr(p, '\n', end - p);
+        const char *lineEnd = newline ? newline : end;
+        bool negative = (p[0] == '-');
+        /* same grammar as parseLine: optional '-', then digits only, any
+           number of leading zeros */
+        const char *q = p + negative;
+        while (q + 1 < lineEnd && *q == '0' && (unsigned)(q[1] - '0') < 10) q++;
+        size_t length = lineEnd - q;
+        if (length + negative < sizeof(line) && (negative || (unsigned)(p[0] - '0') < 10)) {
+            line[0] = '-';
+            memcpy(line + negative, q, length);
+            line[length + negative] = '\0';
+            char *stop;
+            long value = strtol(line, &stop, 10);
+            if (stop != line && (*stop == '\0' || *stop == '\r') && value >= INT_MIN && value <= INT_MAX) {
+                out[count++] = (int)value;
+            }
+        }
+        p = newline ? newline + 1 : end;
+    }
+    return count;
+}
+
+/* ------------------------------------------------------------------ */
+/* Driver                                                             */
+/* ------------------------------------------------------------------ */
+
+int generate(const char *path, long count, int seed) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        printf("Error opening %s\n", path);
+        return 1;
+    }
+    srand(seed);
+    for (long i = 0; i < count; i++) {
+        fprintf(file, "%d\n", rand() - RAND_MAX / 2);
+    }
+    fclose(file);
+    return 0;
+}
+
+double timeDiff(struct timeval start, struct timeval end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--generate") == 0) {
+        if (argc < 4) {
+            printf("Usage: %s --generate <file> <count> <seed>\n", argv[0]);
+            return 1;
+        }
+        return generate(argv[2], atol(argv[3]), (argc > 4) ? atoi(argv[4]) : 42);
+    }
+    if (argc < 2) {
+        printf("Usage: %s <file> <num_threads>\n", argv[0]);
+        printf("       %s --generate <file> <count> <seed>\n", argv[0]);
+        return 1;
+    }
+
+    int numThreads = (argc > 2) ? atoi(argv[2]) : 4;
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > MAXTHREADS) numThreads = MAXTHREADS;
+
+    int fd = open(argv[1], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        printf("Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    size_t size = st.st_size;
+    const char *text = (size > 0) ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : "";
+    close(fd);
+    if (text == MAP_FAILED) {
+        printf("mmap failed\n");
+        return 1;
+    }
+
+    struct timeval start, end;
+    long count, malformed;
+
+    // Measure the single-threaded strtol reference
+    int *reference = (int *)malloc(sizeof(int) * (size / 2 + 1));
+    if (!reference) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+    gettimeofday(&start, NULL);
+    long referenceCount = parseSerial(text, size, reference);
+    gettimeofday(&end, NULL);
+    double serialParseTime = timeDiff(start, end);
+
+    // Measure the parallel parse
+    gettimeofday(&start, NULL);
+    int *array = parseText(text, size, numThreads, &count, &malformed);
+    gettimeofday(&end, NULL);
+    double parseTime = timeDiff(start, end);
+    if (!array) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+
+    bool agree = (count == referenceCount) && memcmp(array, reference, sizeof(int) * count) == 0;
+
+    // Measure the sort
+    gettimeofday(&start, NULL);
+    parallelQuicksort(0, (int)count - 1, spawnDepth(numThreads), array);
+    gettimeofday(&end, NULL);
+    double sortTime = timeDiff(start, end);
+
+    bool sorted = true;
+    for (long i = 1; i < count; i++) {
+        if (array[i - 1] > array[i]) sorted = false;
+    }
+
+    // Output results
+    printf("Elements           : %ld\n", count);
+    printf("Malformed Lines    : %ld\n", malformed);
+    printf("strtol Parse Time  : %f seconds\n", serialParseTime);
+    printf("Parallel Parse Time: %f seconds (%.1f MB/s)\n", parseTime, size / parseTime / 1e6);
+    printf("Sort Time          : %f seconds\n", sortTime);
+    printf("Parse Agrees?      : %s\n", agree ? "True" : "False");
+    printf("Sorted?            : %s\n", sorted ? "True" : "False");
+
+    if (size > 0) munmap((void *)text, size);
+    free(array);
+    free(reference);
+    return 0;
+}
@@ -1,9 +1,13 @@
-/* matrix summation using OpenMP
+/* quicksort using OpenMP
 
    usage with gcc (version 4.2 or higher required):
-     gcc -O -fopenmp -o matrixSum-openmp matrixSum-openmp.c 
-     ./matrixSum-openmp size numWorkers
+     gcc -O -fopenmp -o Quicksort-openmp Quicksort-openmp.c -lm
+     ./Quicksort-openmp size numWorkers printArray dumpFile
 
+   printArray (default 1) prints the unsorted array; dumpFile, if given,
+   receives the sorted array as a one-row int32 binmatrix file, as
+   array_dump in Homework 1 writes it. numWorkers auto
+   lets the cost model in autothreads.h choose, 1 when threads would lose.
 */
 
 #include <omp.h>
@@ -12,7 +16,11 @@ double start_time, end_time;
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <time.h>
+#include "autothreads.h"
+#include "../Homework 1/fastprint.h"  /* formatInt, writeFully, array_dump */
 #define MAXSIZE 10000  /* maximum matrix size */
 #define MAXWORKERS 8   /* maximum number of workers */
 
@@ -31,6 +39,7 @@ void swap(int* a, int* b);
 void parallelQuicksort(int start, int end, int arr[]);
 void insertSort(int arr[], int n);
 int medianOfThree( int start, int end,int* arr);
+int printArray(int fd, int arr[], int n);
 
 /* read command line, initialize, and create threads */
 int main(int argc, char *argv[]) {
@@ -38,11 +47,16 @@ int main(int argc, char *argv[]) {
 
   /* read command line args if any */
   size = (argc > 1)? atoi(argv[1]) : MAXSIZE;
-  numWorkers = (argc > 2)? atoi(argv[2]) : MAXWORKERS;
   if (size > MAXSIZE) size = MAXSIZE;
+  int autoMode = (argc > 2) && strcmp(argv[2], "auto") == 0;
+  numWorkers = autoMode ? autoThreads(WORK_SORT, size, MAXWORKERS, false)
+                        : (argc > 2)? atoi(argv[2]) : MAXWORKERS;
   if (numWorkers > MAXWORKERS) numWorkers = MAXWORKERS;
+  int print = (argc > 3)? atoi(argv[3]) : 1;
+  const char *dumpFile = (argc > 4)? argv[4] : NULL;
 
   omp_set_num_threads(numWorkers);
+  if (autoMode) autoReport(WORK_SORT, size, numWorkers, false);
 
   /* initialize the matrix */
   parallelArr = (int *)malloc(size * sizeof(int));
@@ -65,16 +79,16 @@ int main(int argc, char *argv[]) {
   }
 
 
-/* printing the randomized array*/
-printf("Original Unsorted Array: \n");
-  printf("[");
-  for(i = 0; i <size; i++){
-      if(i!= size-1){
-      printf("%d, ",serialArr[i]);
-    }else { printf("%d", serialArr[i]);
+/* printing the randomized array, formatted in parallel */
+  double outputTime = 0;
+  if (print) {
+    printf("Original Unsorted Array: \n");
+    start_time = omp_get_wtime();
+    if (printArray(STDOUT_FILENO, serialArr, size) < 0) {
+      printf("Error writing the array\n");
     }
+    outputTime += omp_get_wtime() - start_time;
   }
-    printf("]\n");
   start_time = omp_get_wtime();
   serialQuicksort(0,size-1, serialArr);
   end_time = omp_get_wtime();
@@ -91,8 +105,19 @@ printf("Original Unsorted Array: \n");
 
   end_time = omp_get_wtime();
 
+  double parallelTime = end_time - start_time;
+
+  if (dumpFile) {
+    start_time = omp_get_wtime();
+    if (array_dump(dumpFile, parallelArr, size) < 0) {
+      printf("Error dumping the array to %s\n", dumpFile);
+    }
+    outputTime += omp_get_wtime() - start_time;
+  }
+
   printf("Serial Time: %g\n", serialTime);
-  printf("Parallel time: %g\n", end_time - start_time);
+  printf("Parallel time: %g\n", parallelTime);
+  if (print || dumpFile) printf("Output time: %g\n", outputTime);
   free(serialArr);
   free(parallelArr);
 }
@@ -179,4 +204,47 @@ int medianOfThree(int left, int right, int *array) {
     if (array[left] > array[right]) swap(&array[left], &array[right]);
     if (array[mid] > array[right]) swap(&array[mid], &array[right]);
     return mid;
-}
\ No newline at end of file
+}
+
+/* prints "[a, b, c]\n"; every thread formats whole blocks into its own
+   buffer and the ordered clause writes the blocks in array order. Blocks
+   are n / threads elements, so every thread gets one, but at most
+   PRINT_BLOCK */
+int printArray(int fd, int arr[], int n){
+  int threads = omp_get_max_threads();
+  long blockSize = ((long)n + threads - 1) / threads;
+  if (blockSize > PRINT_BLOCK) blockSize = PRINT_BLOCK;
+  if (blockSize < 1) blockSize = 1;
+  long blocks = ((long)n + blockSize - 1) / blockSize;
+  int error = 0;
+
+  fflush(stdout);
+  if (writeFully(fd, "[", 1) < 0) return -1;
+
+#pragma omp parallel
+{
+  char *buffer = (char *)malloc(blockSize * PRINT_INT_CHARS);
+
+  #pragma omp for ordered schedule(static, 1)
+  for (long b = 0; b < blocks; b++) {
+    int first = b * blockSize;
+    int last = (first + blockSize < n) ? first + blockSize : n;
+    char *p = buffer;
+
+    for (int i = first; i < last && buffer; i++) {
+      p = formatInt(p, arr[i]);
+      if (i != n - 1) {
+        *p++ = ',';
+        *p++ = ' ';
+      }
+    }
+
+    #pragma omp ordered
+    if (!buffer || (!error && writeFully(fd, buffer, p - buffer) < 0)) error = 1;
+  }
+  free(buffer);
+}
+
+  if (error || writeFully(fd, "]\n", 2) < 0) return -1;
+  return 0;
+}
@@ -0,0 +1,246 @@
+/* thread placement for the pthread and OpenMP programs
+
+   affinityInit(spec) builds a map from worker number to CPU, where spec is
+
+     none      no pinning (the default)
+     compact   fill a core's hardware threads, then the next core, then
+               the next package
+     scatter   one worker per package in turn, distinct cores before
+               hardware threads of a core already used
+     0,2,4-7   an explicit list, in the order given
+
+   The topology comes from /sys/devices/system/cpu; only CPUs in the
+   process's affinity mask are used, so taskset and cgroup limits are
+   respected. With more workers than CPUs the map wraps around.
+
+   Worker w is pinned to affinityMap.cpus[w % count]: pthreads through
+   affinitySetAttr before pthread_create or affinityPinSelf from the
+   thread itself, OpenMP threads by affinityPinOpenMP, which pins the
+   threads of one parallel region by thread number. libgomp keeps those
+   threads for later regions of at most as many threads, so the calling
+   thread (worker 0 in both worlds) and every team member keep their CPU.
+
+   Needs _GNU_SOURCE defined before the first #include of the program.
+*/
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+#include <omp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define AFFINITY_MAXCPUS 1024
+
+typedef struct {
+    int cpu;
+    int package;      /* physical_package_id */
+    int core;         /* core_id within the package */
+    int coreRank;     /* index of the core among its package's cores */
+    int threadRank;   /* index of the CPU among its core's hardware threads */
+} CpuInfo;
+
+typedef struct {
+    const char *policy;              /* compact, scatter or list */
+    int count;                       /* 0: no pinning */
+    CpuInfo cpus[AFFINITY_MAXCPUS];  /* worker w runs on cpus[w % count] */
+} AffinityMap;
+
+static AffinityMap affinityMap;
+
+/* Parse a sysfs-style CPU list ("0-3,8,10-11") into set; false if malformed */
+static inline bool affinityParseList(const char *text, bool *set) {
+    memset(set, 0, sizeof(bool) * AFFINITY_MAXCPUS);
+    while (*text && *text != '\n') {
+        char *end;
+        long first = strtol(text, &end, 10), last = first;
+        if (end == text || first < 0) return false;
+        if (*end == '-') {
+            text = end + 1;
+            last = strtol(text, &end, 10);
+            if (end == text || last < first) return false;
+        }
+        if (last >= AFFINITY_MAXCPUS) return false;
+        for (long c = first; c <= last; c++) set[c] = true;
+        text = end;
+        if (*text == ',') text++;
+        else if (*text && *text != '\n') return false;
+    }
+    return true;
+}
+
+/* One integer from a sysfs file, or fallback */
+static inline int affinityReadInt(const char *path, int fallback) {
+    FILE *file = fopen(path, "r");
+    int value;
+    if (!file) return fallback;
+    if (fscanf(file, "%d", &value) != 1) value = fallback;
+    fclose(file);
+    return value;
+}
+
+/* Package and core of cpu; a missing topology counts every CPU as a core */
+static inline CpuInfo affinityCpuInfo(int cpu) {
+    char path[128];
+    CpuInfo info = { cpu, 0, cpu, 0, 0 };
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+    info.package = affinityReadInt(path, 0);
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+    info.core = affinityReadInt(path, cpu);
+    return info;
+}
+
+static inline int compareCompact(const void *a, const void *b) {
+    const CpuInfo *x = (const CpuInfo *)a, *y = (const CpuInfo *)b;
+    if (x->package != y->package) return x->package - y->package;
+    if (x->core != y->core) return x->core - y->core;
+    return x->cpu - y->cpu;
+}
+
+static inline int compareScatter(const void *a, const void *b) {
+    const CpuInfo *x = (const CpuInfo *)a, *y = (const CpuInfo *)b;
+    if (x->threadRank != y->threadRank) return x->threadRank - y->threadRank;
+    if (x->coreRank != y->coreRank) return x->coreRank - y->coreRank;
+    if (x->package != y->package) return x->package - y->package;
+    return x->cpu - y->cpu;
+}
+
+/* Sort cpus[0..count) into compact or scatter order */
+static inline void affinityOrder(CpuInfo *cpus, int count, bool scatter) {
+    /* rank cores within packages and hardware threads within cores,
+       walking the CPUs in compact order */
+    qsort(cpus, count, sizeof(CpuInfo), compareCompact);
+    for (int k = 0; k < count; k++) {
+        CpuInfo *info = &cpus[k], *previous = (k > 0) ? info - 1 : NULL;
+        if (!previous || previous->package != info->package) {
+            info->coreRank = 0;
+            info->threadRank = 0;
+        } else if (previous->core != info->core) {
+            info->coreRank = previous->coreRank + 1;
+            info->threadRank = 0;
+        } else {
+            info->coreRank = previous->coreRank;
+            info->threadRank = previous->threadRank + 1;
+        }
+    }
+    if (scatter) qsort(cpus, count, sizeof(CpuInfo), compareScatter);
+}
+
+/* Build affinityMap from spec; prints a message and returns false if
+   spec names no usable CPU */
+static inline bool affinityInit(const char *spec) {
+    static bool usable[AFFINITY_MAXCPUS];
+    cpu_set_t allowed;
+
+    affinityMap.count = 0;
+    affinityMap.policy = spec;
+    if (strcmp(spec, "none") == 0) return true;
+
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        perror("sched_getaffinity");
+        return false;
+    }
+    FILE *file = fopen("/sys/devices/system/cpu/online", "r");
+    char online[4096] = "";
+    if (file) {
+        if (!fgets(online, sizeof(online), file)) online[0] = '\0';
+        fclose(file);
+    }
+    if (!online[0] || !affinityParseList(online, usable)) {
+        /* no sysfs: whatever the affinity mask allows */
+        for (int c = 0; c < AFFINITY_MAXCPUS; c++) usable[c] = c < CPU_SETSIZE && CPU_ISSET(c, &allowed);
+    }
+    for (int c = 0; c < AFFINITY_MAXCPUS && c < CPU_SETSIZE; c++) {
+        if (!CPU_ISSET(c, &allowed)) usable[c] = false;
+    }
+
+    if (strcmp(spec, "compact") == 0 || strcmp(spec, "scatter") == 0) {
+        for (int c = 0; c < AFFINITY_MAXCPUS; c++) {
+            if (usable[c]) affinityMap.cpus[affinityMap.count++] = affinityCpuInfo(c);
+        }
+        affinityOrder(affinityMap.cpus, affinityMap.count, spec[0] == 's');
+    } else {
+        /* an explicit list keeps the order it was written in */
+        affinityMap.policy = "list";
+        const char *text = spec;
+        while (*text) {
+            char *end;
+            long first = strtol(text, &end, 10), last = first;
+            if (end == text || first < 0) break;
+            if (*end == '-') {
+                text = end + 1;
+                last = strtol(text, &end, 10);
+                if (end == text || last < first) break;
+            }
+            for (long c = first; c <= last && affinityMap.count < AFFINITY_MAXCPUS; c++) {
+                if (c >= AFFINITY_MAXCPUS || !usable[c]) {
+                    printf("Affinity: CPU %ld is not available\n", c);
+                    affinityMap.count = 0;
+                    return false;
+                }
+                affinityMap.cpus[affinityMap.count++] = affinityCpuInfo((int)c);
+            }
+            text = end;
+            if (*text == ',') text++;
+            else if (*text) break;
+        }
+        if (*text) {
+            printf("Affinity: cannot parse \"%s\"\n", spec);
+            affinityMap.count = 0;
+            return false;
+        }
+    }
+
+    if (affinityMap.count == 0) {
+        printf("Affinity: no CPUs for \"%s\"\n", spec);
+        return false;
+    }
+    return true;
+}
+
+/* The CPU set for worker, or false when not pinning */
+static inline bool affinityCpuSet(int worker, cpu_set_t *set) {
+    if (affinityMap.count == 0) return false;
+    CPU_ZERO(set);
+    CPU_SET(affinityMap.cpus[worker % affinityMap.count].cpu, set);
+    return true;
+}
+
+/* Make threads created with attr start on worker's CPU */
+static inline void affinitySetAttr(pthread_attr_t *attr, int worker) {
+    cpu_set_t set;
+    if (affinityCpuSet(worker, &set)) pthread_attr_setaffinity_np(attr, sizeof(set), &set);
+}
+
+/* Move the calling thread to worker's CPU */
+static inline void affinityPinSelf(int worker) {
+    cpu_set_t set;
+    if (affinityCpuSet(worker, &set)) pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+/* Pin the threads of an OpenMP team of the given size by thread number */
+static inline void affinityPinOpenMP(int threads) {
+    if (affinityMap.count == 0) return;
+    #pragma omp parallel num_threads(threads)
+    affinityPinSelf(omp_get_thread_num());
+}
+
+/* Print the worker to CPU mapping for the given number of workers */
+static inline void affinityReport(int workers) {
+    if (affinityMap.count == 0) {
+        printf("Affinity: none\n");
+        return;
+    }
+    printf("Affinity: %s, worker -> cpu (package/core):", affinityMap.policy);
+    for (int w = 0; w < workers; w++) {
+        const CpuInfo *info = &affinityMap.cpus[w % affinityMap.count];
+        printf(" %d->%d (%d/%d)", w, info->cpu, info->package, info->core);
+    }
+    printf("\n");
+}
+
+#endif /* AFFINITY_H */
@@ -0,0 +1,258 @@
+/* automatic thread counts from a per-machine cost model
+
+   Small inputs do not pay for their threads: a 500 x 500 sum barely gains
+   and a quicksort of 10000 elements gets slower with 8 threads. Instead of
+   guessing numWorkers, a program can ask autoThreads for the count the
+   model predicts to be fastest, which is 1 (run serially) whenever the
+   fork/join overhead outweighs the work saved.
+
+   The model, with p threads on c CPUs and e = min(p, c):
+
+     T(1) = work                   (no threads, no overhead)
+     T(p) = base + perThread * p + work(e)
+
+     sum of n cells   work(e) = sumCost * n / e
+     sort of n ints   work(e) = sortCost * (2n (1 - 1/e) + n (log2 n - log2 e) / e)
+
+   The sort term is a quicksort whose first log2 e partition levels run
+   with only 1, 2, 4, ... threads busy, and whose remaining levels are
+   shared evenly. base and perThread are measured separately for OpenMP
+   teams and for pthread_create/join, sumCost and sortCost on serial
+   kernels, all once per machine. The result is cached in the file named
+   by AUTOTHREADS_CACHE, or $HOME/.autothreads; the cache is ignored if
+   the CPU count has changed, and deleting it forces a recalibration.
+*/
+#ifndef AUTOTHREADS_H
+#define AUTOTHREADS_H
+
+#include <math.h>
+#include <omp.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CALIBRATE_SUM_CELLS  (1 << 22)
+#define CALIBRATE_SORT_INTS  (1 << 18)
+#define CALIBRATE_REGIONS    200   /* team forks timed per thread count */
+#define CALIBRATE_SPAWNS     50    /* pthread create/join rounds timed per thread count */
+
+typedef enum { WORK_SUM, WORK_SORT } AutoWork;
+
+typedef struct {
+    int cpus;
+    double ompBase, ompPerThread;           /* seconds to fork and join a team */
+    double pthreadBase, pthreadPerThread;   /* seconds to create and join threads */
+    double sumCost;                         /* seconds per matrix cell */
+    double sortCost;                        /* seconds per element per partition level */
+} CostModel;
+
+/* ---------------------------------------------------------------- */
+/* calibration                                                       */
+/* ---------------------------------------------------------------- */
+
+static inline void calibrationQuicksort(int left, int right, int *array) {
+    while (left < right) {
+        int pivot = array[left + (right - left) / 2], i = left, j = right;
+        while (i <= j) {
+            while (array[i] < pivot) i++;
+            while (array[j] > pivot) j--;
+            if (i <= j) {
+                int t = array[i];
+                array[i++] = array[j];
+                array[j--] = t;
+            }
+        }
+        if (j - left < right - i) {
+            calibrationQuicksort(left, j, array);
+            left = i;
+        } else {
+            calibrationQuicksort(i, right, array);
+            right = j;
+        }
+    }
+}
+
+/* xorshift, so that calibrating leaves the program's rand() sequence alone */
+static inline unsigned calibrationRandom(unsigned *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static inline void *calibrationIdle(void *arg) {
+    return arg;
+}
+
+/* Seconds for one fork and join of a team of threads */
+static inline double timeOmpRegion(int threads) {
+    volatile int sink = 0;
+    #pragma omp parallel num_threads(threads)
+    sink = 1;
+    double start = omp_get_wtime();
+    for (int r = 0; r < CALIBRATE_REGIONS; r++) {
+        #pragma omp parallel num_threads(threads)
+        sink = r;
+    }
+    (void)sink;
+    return (omp_get_wtime() - start) / CALIBRATE_REGIONS;
+}
+
+/* Seconds to create and join threads pthreads */
+static inline double timePthreadSpawn(int threads) {
+    pthread_t workers[threads];
+    double start = omp_get_wtime();
+    for (int r = 0; r < CALIBRATE_SPAWNS; r++) {
+        for (int t = 0; t < threads; t++) pthread_create(&workers[t], NULL, calibrationIdle, NULL);
+        for (int t = 0; t < threads; t++) pthread_join(workers[t], NULL);
+    }
+    return (omp_get_wtime() - start) / CALIBRATE_SPAWNS;
+}
+
+/* Fit base + perThread * p through the overheads at 2 and high threads */
+static inline void fitOverhead(double atTwo, double atHigh, int high, double *base, double *perThread) {
+    *perThread = (high > 2) ? (atHigh - atTwo) / (high - 2) : atTwo / 2;
+    if (*perThread < 0) *perThread = 0;
+    *base = atTwo - 2 * *perThread;
+    if (*base < 0) *base = 0;
+}
+
+static inline void costModelCalibrate(CostModel *model) {
+    unsigned state = 2463534242u;
+    model->cpus = omp_get_num_procs();
+    int high = (model->cpus > 2) ? model->cpus : 2;
+
+    fitOverhead(timeOmpRegion(2), timeOmpRegion(high), high, &model->ompBase, &model->ompPerThread);
+    fitOverhead(timePthreadSpawn(2), timePthreadSpawn(high), high,
+                &model->pthreadBase, &model->pthreadPerThread);
+
+    /* sum, max and min with positions, as the matrixSum kernels do; best of three */
+    int *cells = (int *)malloc(sizeof(int) * CALIBRATE_SUM_CELLS);
+    for (int k = 0; k < CALIBRATE_SUM_CELLS; k++) cells[k] = calibrationRandom(&state) % 100;
+    model->sumCost = INFINITY;
+    for (int r = 0; r < 3; r++) {
+        double start = omp_get_wtime();
+        long long sum = 0;
+        int max = cells[0], min = cells[0], maxAt = 0, minAt = 0;
+        for (int k = 0; k < CALIBRATE_SUM_CELLS; k++) {
+            int v = cells[k];
+            sum += v;
+            if (v > max) { max = v; maxAt = k; }
+            if (v < min) { min = v; minAt = k; }
+        }
+        double cost = (omp_get_wtime() - start) / CALIBRATE_SUM_CELLS;
+        volatile long long sink = sum + maxAt + minAt;
+        (void)sink;
+        if (cost < model->sumCost) model->sumCost = cost;
+    }
+    free(cells);
+
+    int *ints = (int *)malloc(sizeof(int) * CALIBRATE_SORT_INTS);
+    model->sortCost = INFINITY;
+    for (int r = 0; r < 3; r++) {
+        for (int k = 0; k < CALIBRATE_SORT_INTS; k++) ints[k] = (int)(calibrationRandom(&state) >> 1);
+        double start = omp_get_wtime();
+        calibrationQuicksort(0, CALIBRATE_SORT_INTS - 1, ints);
+        double cost = (omp_get_wtime() - start) / (CALIBRATE_SORT_INTS * log2(CALIBRATE_SORT_INTS));
+        if (cost < model->sortCost) model->sortCost = cost;
+    }
+    free(ints);
+}
+
+/* ---------------------------------------------------------------- */
+/* cache                                                             */
+/* ---------------------------------------------------------------- */
+
+static inline void costModelPath(char *path, size_t n) {
+    const char *cache = getenv("AUTOTHREADS_CACHE"), *home = getenv("HOME");
+    if (cache) snprintf(path, n, "%s", cache);
+    else if (home) snprintf(path, n, "%s/.autothreads", home);
+    else snprintf(path, n, ".autothreads");
+}
+
+static inline bool costModelLoad(CostModel *model, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+    int fields = fscanf(file, "cpus %d ompBase %lf ompPerThread %lf pthreadBase %lf "
+                        "pthreadPerThread %lf sumCost %lf sortCost %lf",
+                        &model->cpus, &model->ompBase, &model->ompPerThread, &model->pthreadBase,
+                        &model->pthreadPerThread, &model->sumCost, &model->sortCost);
+    fclose(file);
+    return fields == 7 && model->cpus == omp_get_num_procs();
+}
+
+static inline void costModelSave(const CostModel *model, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) return;  /* no cache, calibrate again next time */
+    fprintf(file, "cpus %d\nompBase %.9g\nompPerThread %.9g\npthreadBase %.9g\n"
+            "pthreadPerThread %.9g\nsumCost %.9g\nsortCost %.9g\n",
+            model->cpus, model->ompBase, model->ompPerThread, model->pthreadBase,
+            model->pthreadPerThread, model->sumCost, model->sortCost);
+    fclose(file);
+}
+
+/* The machine's model: cached, or calibrated now and cached */
+static inline const CostModel *costModel(void) {
+    static CostModel model;
+    static bool ready = false;
+    if (!ready) {
+        char path[4096];
+        costModelPath(path, sizeof(path));
+        if (!costModelLoad(&model, path)) {
+            costModelCalibrate(&model);
+            costModelSave(&model, path);
+        }
+        ready = true;
+    }
+    return &model;
+}
+
+/* ---------------------------------------------------------------- */
+/* prediction                                                        */
+/* ---------------------------------------------------------------- */
+
+/* Predicted seconds for n units of work on threads threads */
+static inline double predictTime(const CostModel *model, AutoWork work, double n, int threads, bool pthreads) {
+    int e = (threads < model->cpus) ? threads : model->cpus;
+    double levels = (n > 1) ? log2(n) : 0;
+    double time;
+    if (e < 1) e = 1;
+    if (work == WORK_SUM) {
+        time = model->sumCost * n / e;
+    } else {
+        double shared = levels - log2(e);
+        time = model->sortCost * (2 * n * (1 - 1.0 / e) + n * (shared > 0 ? shared : 0) / e);
+    }
+    if (threads > 1) {
+        time += pthreads ? model->pthreadBase + model->pthreadPerThread * threads
+                         : model->ompBase + model->ompPerThread * threads;
+    }
+    return time;
+}
+
+/* The number of threads in [1, maxThreads] with the lowest predicted
+   time; ties go to fewer threads */
+static inline int autoThreads(AutoWork work, double n, int maxThreads, bool pthreads) {
+    const CostModel *model = costModel();
+    int best = 1;
+    double bestTime = predictTime(model, work, n, 1, pthreads);
+    for (int p = 2; p <= maxThreads; p++) {
+        double time = predictTime(model, work, n, p, pthreads);
+        if (time < bestTime) {
+            best = p;
+            bestTime = time;
+        }
+    }
+    return best;
+}
+
+/* Print the choice and the predictions behind it */
+static inline void autoReport(AutoWork work, double n, int threads, bool pthreads) {
+    const CostModel *model = costModel();
+    printf("Auto threads: %d of %d CPUs (predicted %.6f s, serial %.6f s)\n", threads, model->cpus,
+           predictTime(model, work, n, threads, pthreads), predictTime(model, work, n, 1, pthreads));
+}
+
+#endif /* AUTOTHREADS_H */
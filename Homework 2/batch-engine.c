@@ -0,0 +1,353 @@
+/* batch throughput driver: many independent sorts and matrix sums
+
+   Instead of one big input per process, a stream of jobs is run on one
+   OpenMP team that serves as the shared pool. One thread hands the jobs
+   out as tasks, in arrival order; every thread, the one handing out
+   included, executes them.
+
+     small jobs  (at most cutoff elements) run on whichever thread picks
+                 them up, serially, so many of them proceed side by side
+     large jobs  are split over the same pool: a sort becomes the
+                 omp-cutoff engine of sortengine.h inside a taskgroup,
+                 a sum becomes a taskloop over row ranges whose partial
+                 results are combined with the earlier-position tie rule
+
+   The latency of a job runs from its arrival to its completion. With
+   --rate r the jobs arrive r per second and the thread handing them out
+   spins until each arrival time; by default they all arrive at once and
+   the latency includes the time spent queued. Throughput is jobs and
+   elements per second of wall time. Every job's result is checked after
+   the batch.
+
+   Jobs are generated, with sizes log-uniform in [min, max] elements and
+   the fraction given by --sums being matrix sums of about sqrt x sqrt,
+   or read with --file from lines "sort n" and "sum rows cols" ("-" for
+   stdin).
+
+   usage with gcc:
+     gcc -O2 -fopenmp -o batch-engine batch-engine.c -lpthread -lm
+     ./batch-engine --threads n --jobs j --min a --max b --sums f --rate r
+                    --cutoff c --file path --affinity spec seed
+*/
+
+#define _GNU_SOURCE
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sortengine.h"
+
+#define MAXJOBS      1000000
+#define SPLITS_PER_THREAD 4  /* row ranges per thread in a large sum */
+
+typedef enum { JOB_SORT, JOB_SUM } JobKind;
+
+/* a matrix element's value and position */
+typedef struct {
+    int row;
+    int col;
+    int value;
+} MatrixElement;
+
+typedef struct {
+    long long sum;
+    MatrixElement max;
+    MatrixElement min;
+} Result;
+
+typedef struct {
+    JobKind kind;
+    int rows, cols;        /* a sort is one row of cols elements */
+    int *data;             /* row-major */
+    long long checksum;    /* sum of the input, to check sorts */
+    bool large;
+    double arrival, done;
+    Result result;         /* of a sum */
+} Job;
+
+static const Result emptyResult = { 0, { .value = INT_MIN }, { .value = INT_MAX } };
+
+/* ---------------------------------------------------------------- */
+/* job kernels                                                       */
+/* ---------------------------------------------------------------- */
+
+/* fold rows [first, last] of job into r */
+static void reduceRows(const Job *job, int first, int last, Result *r) {
+    Result local = *r;
+    for (int i = first; i <= last; i++) {
+        const int *row = job->data + (size_t)i * job->cols;
+        for (int j = 0; j < job->cols; j++) {
+            int v = row[j];
+            local.sum += v;
+            if (v > local.max.value) local.max = (MatrixElement){ i, j, v };
+            if (v < local.min.value) local.min = (MatrixElement){ i, j, v };
+        }
+    }
+    *r = local;
+}
+
+static bool before(MatrixElement a, MatrixElement b) {
+    return a.row < b.row || (a.row == b.row && a.col < b.col);
+}
+
+/* merge b into a; ties go to the earlier position whatever the order */
+static void combine(Result *a, const Result *b) {
+    a->sum += b->sum;
+    if (b->max.value > a->max.value || (b->max.value == a->max.value && before(b->max, a->max)))
+        a->max = b->max;
+    if (b->min.value < a->min.value || (b->min.value == a->min.value && before(b->min, a->min)))
+        a->min = b->min;
+}
+
+/* Runs inside a task of the pool */
+static void runJob(Job *job, int threads) {
+    int n = job->rows * job->cols;
+    if (job->kind == JOB_SORT) {
+        if (!job->large) {
+            serialQuicksort(0, n - 1, job->data);
+        } else {
+            #pragma omp taskgroup
+            cutoffQuicksort(0, n - 1, 0, 2 * spawnDepth(threads) + 2, job->data, NULL);
+        }
+    } else {
+        job->result = emptyResult;
+        if (!job->large) {
+            reduceRows(job, 0, job->rows - 1, &job->result);
+        } else {
+            int parts = SPLITS_PER_THREAD * threads;
+            if (parts > job->rows) parts = job->rows;
+            Result partial[parts];
+            #pragma omp taskloop grainsize(1) shared(partial)
+            for (int p = 0; p < parts; p++) {
+                partial[p] = emptyResult;
+                reduceRows(job, (long)job->rows * p / parts, (long)job->rows * (p + 1) / parts - 1, &partial[p]);
+            }
+            for (int p = 0; p < parts; p++) combine(&job->result, &partial[p]);
+        }
+    }
+    job->done = omp_get_wtime();
+}
+
+/* Whether job's result is right */
+static bool checkJob(const Job *job) {
+    int n = job->rows * job->cols;
+    if (job->kind == JOB_SORT) {
+        long long sum = 0;
+        for (int i = 0; i < n; i++) {
+            if (i > 0 && job->data[i - 1] > job->data[i]) return false;
+            sum += job->data[i];
+        }
+        return sum == job->checksum;
+    }
+    Result reference = emptyResult;
+    reduceRows(job, 0, job->rows - 1, &reference);
+    return memcmp(&reference, &job->result, sizeof(Result)) == 0;
+}
+
+/* ---------------------------------------------------------------- */
+/* job stream                                                        */
+/* ---------------------------------------------------------------- */
+
+static bool makeJob(Job *job, JobKind kind, int rows, int cols, int cutoff) {
+    if (rows < 1) rows = 1;
+    if (cols < 1) cols = 1;
+    job->kind = kind;
+    job->rows = rows;
+    job->cols = cols;
+    job->large = (long long)rows * cols > cutoff;
+    job->checksum = 0;
+    job->data = (int *)malloc(sizeof(int) * rows * cols);
+    if (!job->data) return false;
+    for (int i = 0; i < rows * cols; i++) {
+        job->data[i] = (kind == JOB_SORT) ? rand() % (rows * cols < INT_MAX / 10 ? rows * cols * 10 : INT_MAX)
+                                          : rand() % 100;
+        job->checksum += job->data[i];
+    }
+    return true;
+}
+
+/* Jobs from lines "sort n" / "sum rows cols" into *jobs, grown as lines
+   are read; returns the count or -1 */
+static int readJobs(const char *path, Job **jobs, int cutoff) {
+    FILE *file = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+    char line[256], kind[16];
+    int count = 0, capacity = 0;
+    if (!file) {
+        perror(path);
+        return -1;
+    }
+    while (count < MAXJOBS && fgets(line, sizeof(line), file)) {
+        int a, b = 0, fields = sscanf(line, "%15s %d %d", kind, &a, &b);
+        bool made;
+        if (fields < 1 || kind[0] == '#') continue;
+        if (count == capacity) {
+            capacity = (capacity > 0) ? 2 * capacity : 64;
+            Job *grown = (Job *)realloc(*jobs, sizeof(Job) * capacity);
+            if (!grown) {
+                printf("Memory allocation error!\n");
+                return -1;
+            }
+            *jobs = grown;
+        }
+        if (strcmp(kind, "sort") == 0 && fields >= 2) made = makeJob(&(*jobs)[count], JOB_SORT, 1, a, cutoff);
+        else if (strcmp(kind, "sum") == 0 && fields == 3) made = makeJob(&(*jobs)[count], JOB_SUM, a, b, cutoff);
+        else {
+            printf("Cannot read job \"%s\"\n", strtok(line, "\n"));
+            return -1;
+        }
+        if (!made) {
+            printf("Memory allocation error!\n");
+            return -1;
+        }
+        count++;
+    }
+    if (file != stdin) fclose(file);
+    return count;
+}
+
+/* ---------------------------------------------------------------- */
+/* report                                                            */
+/* ---------------------------------------------------------------- */
+
+static int compareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile q of sorted[0..n) */
+static double percentile(const double *sorted, int n, double q) {
+    int rank = (int)ceil(q * n);
+    return sorted[(rank > 0 ? rank : 1) - 1];
+}
+
+/* Latency percentiles in milliseconds of the jobs that are large or not */
+static void latencyLine(const char *label, const Job *jobs, int numJobs, int large, double *latency) {
+    int n = 0;
+    for (int j = 0; j < numJobs; j++) {
+        if (large < 0 || jobs[j].large == large) latency[n++] = jobs[j].done - jobs[j].arrival;
+    }
+    if (n == 0) {
+        printf("%-8s %8d\n", label, 0);
+        return;
+    }
+    qsort(latency, n, sizeof(double), compareDoubles);
+    printf("%-8s %8d %10.3f %10.3f %10.3f %10.3f\n", label, n, 1e3 * percentile(latency, n, 0.50),
+           1e3 * percentile(latency, n, 0.90), 1e3 * percentile(latency, n, 0.99), 1e3 * latency[n - 1]);
+}
+
+static void usage(const char *program) {
+    printf("Usage: %s --threads n --jobs j --min a --max b --sums f --rate r --cutoff c "
+           "--file path --affinity spec seed\n", program);
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = NULL, *affinity = "none";
+    int threads = omp_get_max_threads(), numJobs = 1000, minSize = 1000, maxSize = 200000;
+    int cutoff = THRESHOLD, seed = -1;
+    double sums = 0.5, rate = 0;
+
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--threads") == 0 && a + 1 < argc) threads = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--jobs") == 0 && a + 1 < argc) numJobs = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--min") == 0 && a + 1 < argc) minSize = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--max") == 0 && a + 1 < argc) maxSize = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--sums") == 0 && a + 1 < argc) sums = atof(argv[++a]);
+        else if (strcmp(argv[a], "--rate") == 0 && a + 1 < argc) rate = atof(argv[++a]);
+        else if (strcmp(argv[a], "--cutoff") == 0 && a + 1 < argc) cutoff = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--file") == 0 && a + 1 < argc) path = argv[++a];
+        else if (strcmp(argv[a], "--affinity") == 0 && a + 1 < argc) affinity = argv[++a];
+        else if (argv[a][0] == '-' && argv[a][1] == '-') { usage(argv[0]); return 1; }
+        else seed = atoi(argv[a]);
+    }
+    if (threads < 1) threads = 1;
+    if (threads > SORT_MAXTHREADS) threads = SORT_MAXTHREADS;
+    if (numJobs < 1) numJobs = 1;
+    if (numJobs > MAXJOBS) numJobs = MAXJOBS;
+    if (minSize < 1) minSize = 1;
+    if (maxSize < minSize) maxSize = minSize;
+    if (rate < 0) rate = 0;
+    if (!affinityInit(affinity)) return 1;
+    affinityPinOpenMP(threads);
+
+    Job *jobs = path ? NULL : (Job *)malloc(sizeof(Job) * numJobs);
+    double *latency = NULL;
+    if (!path && !jobs) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+    srand(seed >= 0 ? seed : time(NULL));
+    if (path) {
+        if ((numJobs = readJobs(path, &jobs, cutoff)) < 0) return 1;
+    } else {
+        for (int j = 0; j < numJobs; j++) {
+            int size = (int)exp(log(minSize) + (log(maxSize) - log(minSize)) * rand() / RAND_MAX);
+            bool made = (rand() < sums * RAND_MAX)
+                            ? makeJob(&jobs[j], JOB_SUM, (int)sqrt(size), size / (int)sqrt(size), cutoff)
+                            : makeJob(&jobs[j], JOB_SORT, 1, size, cutoff);
+            if (!made) {
+                printf("Memory allocation error!\n");
+                return 1;
+            }
+        }
+    }
+    latency = (double *)malloc(sizeof(double) * (numJobs > 0 ? numJobs : 1));
+    if (!latency) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+
+    int numLarge = 0, numSums = 0;
+    long long elements = 0;
+    for (int j = 0; j < numJobs; j++) {
+        numLarge += jobs[j].large;
+        numSums += jobs[j].kind == JOB_SUM;
+        elements += (long long)jobs[j].rows * jobs[j].cols;
+    }
+
+    double start_time = 0, end_time;
+    #pragma omp parallel num_threads(threads)
+    {
+        #pragma omp single
+        {
+            start_time = omp_get_wtime();
+            for (int j = 0; j < numJobs; j++) {
+                Job *job = &jobs[j];
+                if (rate > 0) {
+                    job->arrival = start_time + j / rate;
+                    while (omp_get_wtime() < job->arrival) {
+                        #pragma omp taskyield
+                    }
+                } else {
+                    /* all at once: stamping task creation would hide the
+                       wait once the runtime throttles task creation */
+                    job->arrival = start_time;
+                }
+                #pragma omp task firstprivate(job)
+                runJob(job, threads);
+            }
+        }
+    }
+    end_time = omp_get_wtime();
+
+    bool correct = true;
+    for (int j = 0; j < numJobs; j++) correct = correct && checkJob(&jobs[j]);
+
+    double wall = end_time - start_time;
+    printf("Jobs: %d (%d sorts, %d sums, %d large), Threads: %d, cutoff %d elements\n",
+           numJobs, numJobs - numSums, numSums, numLarge, threads, cutoff);
+    affinityReport(threads);
+    printf("Wall time: %.6f s, Throughput: %.1f jobs/s, %.1f Melements/s\n",
+           wall, numJobs / wall, elements / wall / 1e6);
+    printf("%-8s %8s %10s %10s %10s %10s\n", "latency", "jobs", "p50 (ms)", "p90 (ms)", "p99 (ms)", "max (ms)");
+    latencyLine("all", jobs, numJobs, -1, latency);
+    latencyLine("small", jobs, numJobs, 0, latency);
+    latencyLine("large", jobs, numJobs, 1, latency);
+    printf("Results correct? %s\n", correct ? "True" : "False");
+
+    for (int j = 0; j < numJobs; j++) free(jobs[j].data);
+    free(jobs);
+    free(latency);
+    return correct ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+#!/bin/bash
+
+# Compare matrixSum-engine strategies on the same matrices
+#   gcc -O2 -fopenmp -o matrixSum-engine matrixSum-engine.c -lpthread -lm
+# or, to add the C++17 parallel algorithms as a column of their own,
+#   g++ -O2 -std=c++17 -c stdpar.cpp
+#   gcc -O2 -fopenmp -DHAVE_STDPAR -o matrixSum-engine matrixSum-engine.c stdpar.o -lpthread -lm -lstdc++ -ltbb
+
+# Matrix sizes, thread counts and strategies
+MATRIX_SIZES=(500 1000 2000 5000 10000)
+THREAD_COUNTS=(1 2 4 8)
+STRATEGIES=(barrier bag omp-static omp-dynamic steal)
+if ./matrixSum-engine --strategy stdpar --runs 1 1 1 1 > /dev/null 2>&1; then
+    STRATEGIES+=(stdpar)
+fi
+RUNS=5  # Number of timed runs per configuration; matrixSum-engine reports the median
+SEED=42
+AFFINITY=${AFFINITY:-compact}  # none, compact, scatter or a CPU list such as 0,2,4-7
+RESULT_FILE="matrixsum_engine_benchmark.csv"
+
+# Initialize the results file
+header="Matrix Size,Threads"
+for strategy in "${STRATEGIES[@]}"; do
+    header="$header,$strategy"
+done
+echo "$header" > $RESULT_FILE
+
+# Run benchmarks
+for size in "${MATRIX_SIZES[@]}"; do
+    for threads in "${THREAD_COUNTS[@]}"; do
+        export OMP_NUM_THREADS=$threads
+        line="$size,$threads"
+        times=()
+        for strategy in "${STRATEGIES[@]}"; do
+            output=$(./matrixSum-engine --strategy $strategy --runs $RUNS --affinity $AFFINITY $size $threads $SEED | awk -v s=$strategy '$1 == s {print $2}')
+            if [[ -z "$output" ]]; then
+                echo "Error: Unable to capture time for strategy=$strategy, size=$size, threads=$threads"
+                output=0
+            fi
+            times+=("$output")
+            line="$line,$output"
+        done
+
+        echo "Matrix Size: $size, Threads: $threads, ${STRATEGIES[*]}: ${times[*]}"
+        echo "$line" >> $RESULT_FILE
+    done
+done
+
+echo "Benchmarking completed. Results saved to $RESULT_FILE."
@@ -6,6 +6,10 @@ THREAD_COUNTS=(1 2 4 8)
 RUNS=5  # Number of runs for each configuration
 RESULT_FILE="quicksort_benchmarktest.csv"
 
+# Pin the OpenMP threads, packed one per core, so every run uses the same CPUs
+export OMP_PLACES=${OMP_PLACES:-cores}
+export OMP_PROC_BIND=${OMP_PROC_BIND:-close}
+
 # Initialize the results file
 echo "Array Size,Threads,Serial Time,Parallel Time,Speedup" > $RESULT_FILE
 
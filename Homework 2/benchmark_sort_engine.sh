@@ -0,0 +1,57 @@
+#!/bin/bash
+
+# Compare the OpenMP task engines of sort-engine on the same inputs
+#   gcc -O2 -fopenmp -o sort-engine sort-engine.c -lpthread -lm
+# or, to add the C++17 parallel algorithms as a column of their own,
+#   g++ -O2 -std=c++17 -c stdpar.cpp
+#   gcc -O2 -fopenmp -DHAVE_STDPAR -o sort-engine sort-engine.c stdpar.o -lpthread -lm -lstdc++ -ltbb
+
+# Array sizes, thread counts and engines
+ARRAY_SIZES=(1000000 5000000 10000000 50000000)
+THREAD_COUNTS=(1 2 4 8)
+ENGINES=(omp-tasks omp-cutoff omp-taskloop)
+if ./sort-engine --engine stdpar --runs 1 1 1 > /dev/null 2>&1; then
+    ENGINES+=(stdpar)
+fi
+RUNS=5  # Number of timed runs per configuration; sort-engine reports the median
+SEED=42
+AFFINITY=${AFFINITY:-compact}  # none, compact, scatter or a CPU list such as 0,2,4-7
+RESULT_FILE="sort_engine_benchmark.csv"
+
+# Initialize the results file
+header="Array Size,Threads"
+for engine in "${ENGINES[@]}"; do
+    header="$header,$engine"
+done
+echo "$header,Speedup" > $RESULT_FILE
+
+# Run benchmarks
+for size in "${ARRAY_SIZES[@]}"; do
+    for threads in "${THREAD_COUNTS[@]}"; do
+        export OMP_NUM_THREADS=$threads
+        line="$size,$threads"
+        times=()
+        for engine in "${ENGINES[@]}"; do
+            output=$(./sort-engine --engine $engine --threads $threads --runs $RUNS --affinity $AFFINITY $size $SEED | awk -v e=$engine '$1 == e {print $2}')
+            if [[ -z "$output" ]]; then
+                echo "Error: Unable to capture time for engine=$engine, size=$size, threads=$threads"
+                output=0
+            fi
+            times+=("$output")
+            line="$line,$output"
+        done
+
+        # Speedup of the best new task engine over the current task version
+        best=$(printf '%s\n' "${times[@]:1:2}" | sort -n | head -1)
+        if (( $(echo "$best == 0" | bc -l) )); then
+            SPEEDUP="undefined"
+        else
+            SPEEDUP=$(echo "${times[0]} / $best" | bc -l)
+        fi
+
+        echo "Array Size: $size, Threads: $threads, ${ENGINES[*]}: ${times[*]}, Speedup: $SPEEDUP"
+        echo "$line,$SPEEDUP" >> $RESULT_FILE
+    done
+done
+
+echo "Benchmarking completed. Results saved to $RESULT_FILE."
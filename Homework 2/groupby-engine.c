@@ -0,0 +1,128 @@
+/* benchmark driver for the group-by in groupby.h
+
+   n (key, value) pairs are generated with keys drawn from k distinct
+   values spread over the whole int range and values in [-1000, 1000].
+   The sort, hash and auto methods each run on fresh copies of the pairs;
+   one untimed warm-up run, then the median of the timed runs. Every
+   run is checked against a reference built by qsort and a serial scan.
+
+   usage with gcc:
+     gcc -O2 -fopenmp -o groupby-engine groupby-engine.c -lpthread -lm
+     ./groupby-engine --threads n --runs r --keys k size seed
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "groupby.h"
+
+#define MAXRUNS 101
+
+static const struct {
+    const char *name;
+    GroupByMethod method;
+} methods[] = {
+    { "sort", GROUPBY_SORT },
+    { "hash", GROUPBY_HASH },
+    { "auto", GROUPBY_AUTO },
+};
+#define NUM_METHODS (int)(sizeof(methods) / sizeof(methods[0]))
+
+static int compareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Serial reference: sort and scan */
+static int referenceGroups(KeyValue *pairs, int n, Group *groups) {
+    int numGroups = 0;
+    qsort(pairs, n, sizeof(KeyValue), comparePairKeys);
+    for (int i = 0; i < n; i++) {
+        if (i == 0 || pairs[i].key != pairs[i - 1].key) groups[numGroups++] = newGroup(pairs[i].key);
+        addToGroup(&groups[numGroups - 1], pairs[i].value);
+    }
+    return numGroups;
+}
+
+/* Field by field, as Group has padding */
+static bool sameGroups(const Group *a, const Group *b, int n) {
+    for (int g = 0; g < n; g++) {
+        if (a[g].key != b[g].key || a[g].count != b[g].count || a[g].sum != b[g].sum ||
+            a[g].min != b[g].min || a[g].max != b[g].max)
+            return false;
+    }
+    return true;
+}
+
+static void usage(const char *program) {
+    printf("Usage: %s --threads n --runs r --keys k size seed\n", program);
+}
+
+int main(int argc, char *argv[]) {
+    int threads = omp_get_max_threads(), runs = 3, positional = 0;
+    int size = 1000000, keys = 1000, seed = -1;
+
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--threads") == 0 && a + 1 < argc) threads = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--runs") == 0 && a + 1 < argc) runs = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--keys") == 0 && a + 1 < argc) keys = atoi(argv[++a]);
+        else if (argv[a][0] == '-' && argv[a][1] == '-') { usage(argv[0]); return 1; }
+        else if (positional == 0) { size = atoi(argv[a]); positional++; }
+        else if (positional == 1) { seed = atoi(argv[a]); positional++; }
+    }
+    if (size < 0) size = 0;
+    if (keys < 1) keys = 1;
+    if (threads < 1) threads = 1;
+    if (threads > SORT_MAXTHREADS) threads = SORT_MAXTHREADS;
+    if (runs < 1) runs = 1;
+    if (runs > MAXRUNS) runs = MAXRUNS;
+
+    KeyValue *input = (KeyValue *)malloc(sizeof(KeyValue) * (size > 0 ? size : 1));
+    KeyValue *work = (KeyValue *)malloc(sizeof(KeyValue) * (size > 0 ? size : 1));
+    Group *reference = (Group *)malloc(sizeof(Group) * (size > 0 ? size : 1));
+    Group *groups = (Group *)malloc(sizeof(Group) * (size > 0 ? size : 1));
+    if (!input || !work || !reference || !groups) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+    srand(seed >= 0 ? seed : time(NULL));
+    for (int i = 0; i < size; i++) {
+        /* spread key numbers over the int range, negatives included */
+        input[i].key = (int)((uint32_t)(rand() % keys) * 2654435761u);
+        input[i].value = rand() % 2001 - 1000;
+    }
+    memcpy(work, input, sizeof(KeyValue) * size);
+    int numReference = referenceGroups(work, size, reference);
+
+    printf("Pairs: %d, Keys: %d (%d present, about %.0f estimated), Threads: %d, median of %d runs\n",
+           size, keys, numReference, estimateDistinct(input, size), threads, runs);
+    printf("%-8s %12s %10s %8s %10s\n", "method", "time (s)", "groups", "used", "correct?");
+
+    bool allCorrect = true;
+    for (int m = 0; m < NUM_METHODS; m++) {
+        double times[MAXRUNS];
+        bool correct = true;
+        GroupByMethod used = methods[m].method;
+        int numGroups = 0;
+        for (int r = -1; r < runs; r++) {
+            memcpy(work, input, sizeof(KeyValue) * size);
+            double start = omp_get_wtime();
+            numGroups = groupBy(work, size, groups, methods[m].method, threads, &used);
+            double elapsed = omp_get_wtime() - start;
+            if (numGroups != numReference || !sameGroups(groups, reference, numGroups)) correct = false;
+            if (r >= 0) times[r] = elapsed;
+        }
+        qsort(times, runs, sizeof(double), compareDoubles);
+        printf("%-8s %12.6f %10d %8s %10s\n", methods[m].name, times[runs / 2], numGroups,
+               used == GROUPBY_HASH ? "hash" : "sort", correct ? "True" : "False");
+        allCorrect = allCorrect && correct;
+    }
+
+    free(input);
+    free(work);
+    free(reference);
+    free(groups);
+    return allCorrect ? 0 : 1;
+}
@@ -0,0 +1,332 @@
+/* group-by aggregation of (key, value) pairs on the sort engines
+
+   groupBy(pairs, n, groups, method, threads, &used) writes one Group per
+   distinct key (count, sum, min and max of its values) in ascending key
+   order and returns how many there are: the distinct count.
+
+     sort   the pairs are sorted by key with the radix engine's scheme,
+            carrying the values along. Each thread counts the run starts
+            (key differs from its left neighbour) in its block, a prefix
+            sum over the counts gives every thread the index of its first
+            group, and each thread aggregates its block's runs straight
+            into their slots. A run that began in an earlier block is
+            folded into a carry first and merged after a barrier, so one
+            long run never holds up a single thread.
+     hash   every thread aggregates its block into its own open-addressing
+            table, the tables are merged and the few groups are sorted
+            by key. Cheaper than sorting when there are few keys; if the
+            tables fill up it gives up and the sort path runs instead.
+            Also taken on request only while the estimate is at most
+            HASH_MAX_KEYS, so the tables stay small
+     auto   hash when a sample of SAMPLE_SIZE keys estimates at most
+            HASH_MAX_KEYS distinct keys, sort otherwise
+
+   The estimate is the GEE estimator sqrt(n / s) f1 + f2 + f3 + ...,
+   where f1 counts the keys seen once in the sample of s and the others
+   count each key seen more often once. groups must have room for n
+   entries; the sort path reorders pairs, with qsort if the radix sort's
+   scratch cannot be allocated.
+*/
+#ifndef GROUPBY_H
+#define GROUPBY_H
+
+#include <limits.h>
+#include <math.h>
+#include "sortengine.h"
+
+#define SAMPLE_SIZE   4096
+#define HASH_MAX_KEYS 16384  /* estimated distinct keys the hash path takes */
+
+typedef struct {
+    int key;
+    int value;
+} KeyValue;
+
+typedef struct {
+    int key;
+    long long count;
+    long long sum;
+    int min;
+    int max;
+} Group;
+
+typedef enum { GROUPBY_AUTO, GROUPBY_SORT, GROUPBY_HASH } GroupByMethod;
+
+static inline void addToGroup(Group *g, int value) {
+    g->count++;
+    g->sum += value;
+    if (value < g->min) g->min = value;
+    if (value > g->max) g->max = value;
+}
+
+static inline void mergeGroup(Group *a, const Group *b) {
+    a->count += b->count;
+    a->sum += b->sum;
+    if (b->min < a->min) a->min = b->min;
+    if (b->max > a->max) a->max = b->max;
+}
+
+static inline Group newGroup(int key) {
+    return (Group){ key, 0, 0, INT_MAX, INT_MIN };
+}
+
+/* ---------------------------------------------------------------- */
+/* cardinality estimate                                              */
+/* ---------------------------------------------------------------- */
+
+static inline int compareInt(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/* Estimated number of distinct keys, from an evenly spaced sample */
+static inline double estimateDistinct(const KeyValue *pairs, int n) {
+    int s = (n < SAMPLE_SIZE) ? n : SAMPLE_SIZE;
+    int sample[SAMPLE_SIZE];
+    if (s == 0) return 0;
+    for (int i = 0; i < s; i++) sample[i] = pairs[(long)n * i / s].key;
+    qsort(sample, s, sizeof(int), compareInt);
+
+    long once = 0, more = 0;
+    for (int i = 0; i < s;) {
+        int j = i;
+        while (j < s && sample[j] == sample[i]) j++;
+        if (j - i == 1) once++;
+        else more++;
+        i = j;
+    }
+    return sqrt((double)n / s) * once + more;
+}
+
+/* ---------------------------------------------------------------- */
+/* sort path                                                         */
+/* ---------------------------------------------------------------- */
+
+static inline int comparePairKeys(const void *a, const void *b) {
+    int x = ((const KeyValue *)a)->key, y = ((const KeyValue *)b)->key;
+    return (x > y) - (x < y);
+}
+
+/* LSD radix sort of pairs by key, as sortRadix */
+static inline void sortPairs(KeyValue *pairs, int n, int threads) {
+    KeyValue *temp = (KeyValue *)malloc(sizeof(KeyValue) * (n > 0 ? n : 1));
+    long *counts = (long *)malloc(sizeof(long) * threads * RADIX_BUCKETS);  /* counts[t * 256 + d] */
+    KeyValue *from = pairs, *to = temp;
+    if (!temp || !counts) {
+        free(temp);
+        free(counts);
+        qsort(pairs, n, sizeof(KeyValue), comparePairKeys);
+        return;
+    }
+
+    for (int shift = 0; shift < 32; shift += RADIX_BITS) {
+        #pragma omp parallel num_threads(threads)
+        {
+            int t = omp_get_thread_num();
+            int nt = omp_get_num_threads();
+            long first = (long)n * t / nt, last = (long)n * (t + 1) / nt;
+            long *mine = counts + (size_t)t * RADIX_BUCKETS;
+
+            memset(mine, 0, sizeof(long) * RADIX_BUCKETS);
+            for (long i = first; i < last; i++) {
+                mine[(((uint32_t)from[i].key ^ 0x80000000u) >> shift) & (RADIX_BUCKETS - 1)]++;
+            }
+            #pragma omp barrier
+
+            #pragma omp single
+            {
+                long offset = 0;
+                for (int d = 0; d < RADIX_BUCKETS; d++) {
+                    for (int u = 0; u < nt; u++) {
+                        long count = counts[(size_t)u * RADIX_BUCKETS + d];
+                        counts[(size_t)u * RADIX_BUCKETS + d] = offset;
+                        offset += count;
+                    }
+                }
+            }
+
+            for (long i = first; i < last; i++) {
+                to[mine[(((uint32_t)from[i].key ^ 0x80000000u) >> shift) & (RADIX_BUCKETS - 1)]++] = from[i];
+            }
+        }
+        KeyValue *swapped = from;
+        from = to;
+        to = swapped;
+    }
+
+    /* an even number of passes leaves the result in pairs */
+    free(counts);
+    free(temp);
+}
+
+static inline int groupBySort(KeyValue *pairs, int n, Group *groups, int threads) {
+    long heads[SORT_MAXTHREADS], base[SORT_MAXTHREADS];
+    Group carry[SORT_MAXTHREADS];
+    int numGroups = 0;
+
+    sortPairs(pairs, n, threads);
+
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = omp_get_thread_num();
+        int nt = omp_get_num_threads();
+        long first = (long)n * t / nt, last = (long)n * (t + 1) / nt;
+
+        /* run starts in my block */
+        long count = 0;
+        for (long i = first; i < last; i++) {
+            count += (i == 0 || pairs[i].key != pairs[i - 1].key);
+        }
+        heads[t] = count;
+        #pragma omp barrier
+
+        #pragma omp single
+        {
+            long offset = 0;
+            for (int u = 0; u < nt; u++) {
+                base[u] = offset;
+                offset += heads[u];
+            }
+            numGroups = (int)offset;
+        }
+
+        /* the continuation of an earlier block's run goes to my carry,
+           the runs starting here to their own slots */
+        long i = first;
+        carry[t] = newGroup(0);
+        while (i < last && i > 0 && pairs[i].key == pairs[i - 1].key) {
+            addToGroup(&carry[t], pairs[i].value);
+            i++;
+        }
+        long slot = base[t];
+        while (i < last) {
+            Group g = newGroup(pairs[i].key);
+            long j = i;
+            while (j < last && pairs[j].key == pairs[i].key) addToGroup(&g, pairs[j++].value);
+            groups[slot++] = g;
+            i = j;
+        }
+        #pragma omp barrier
+
+        /* the group a carry belongs to is the last one started before it;
+           in thread order, so a run spanning several blocks adds up */
+        #pragma omp single
+        for (int u = 1; u < nt; u++) {
+            if (carry[u].count > 0) mergeGroup(&groups[base[u] - 1], &carry[u]);
+        }
+    }
+    return numGroups;
+}
+
+/* ---------------------------------------------------------------- */
+/* hash path                                                         */
+/* ---------------------------------------------------------------- */
+
+/* MurmurHash3's finalizer: a plain multiplicative hash clusters keys
+   that are themselves multiples of its constant */
+static inline uint32_t hashKey(int key, int bits) {
+    uint32_t h = (uint32_t)key;
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h >> (32 - bits);
+}
+
+/* The slot for key in a table of 2^bits entries (count 0 = empty), or
+   NULL once the table is more than 3/4 full and key is new */
+static inline Group *findGroup(Group *table, int bits, int key, int *used) {
+    uint32_t mask = (1u << bits) - 1;
+    for (uint32_t h = hashKey(key, bits);; h = (h + 1) & mask) {
+        if (table[h].count == 0) {
+            if (*used >= (int)(mask + 1) / 4 * 3) return NULL;
+            (*used)++;
+            table[h] = newGroup(key);
+            return &table[h];
+        }
+        if (table[h].key == key) return &table[h];
+    }
+}
+
+static inline int compareGroupKeys(const void *a, const void *b) {
+    int x = ((const Group *)a)->key, y = ((const Group *)b)->key;
+    return (x > y) - (x < y);
+}
+
+/* log2 of a table size with room for keys at most half full */
+static inline int tableBits(double keys) {
+    int bits = 10;
+    while ((1 << bits) < 2 * keys + 16 && bits < 30) bits++;
+    return bits;
+}
+
+/* Groups by hashing, or -1 if the tables sized for expected keys fill up.
+   A thread's table need not hold more keys than its block has pairs;
+   the merged table (table 0) is sized for all expected keys. */
+static inline int groupByHash(const KeyValue *pairs, int n, Group *groups, double expected, int threads) {
+    long block = ((long)n + threads - 1) / threads;
+    int bits = tableBits(expected < block ? expected : block), mergedBits = tableBits(expected);
+    size_t size = (size_t)1 << bits, mergedSize = (size_t)1 << mergedBits;
+    size_t totalSize = mergedSize + size * threads;
+    Group *tables = (Group *)calloc(totalSize, sizeof(Group));
+    bool full = false;
+    int numGroups = 0;
+    if (!tables) return -1;
+
+    #pragma omp parallel num_threads(threads) reduction(||:full)
+    {
+        int t = omp_get_thread_num();
+        int nt = omp_get_num_threads();
+        long first = (long)n * t / nt, last = (long)n * (t + 1) / nt;
+        Group *mine = tables + mergedSize + size * t;
+        int used = 0;
+        for (long i = first; i < last && !full; i++) {
+            Group *g = findGroup(mine, bits, pairs[i].key, &used);
+            if (g) addToGroup(g, pairs[i].value);
+            else full = true;
+        }
+    }
+
+    /* merge into table 0, then compact and order by key */
+    if (!full) {
+        int used = 0;
+        for (size_t k = mergedSize; k < totalSize && !full; k++) {
+            if (tables[k].count == 0) continue;
+            Group *g = findGroup(tables, mergedBits, tables[k].key, &used);
+            if (g) mergeGroup(g, &tables[k]);
+            else full = true;
+        }
+        for (size_t k = 0; k < mergedSize && !full; k++) {
+            if (tables[k].count > 0) groups[numGroups++] = tables[k];
+        }
+        qsort(groups, numGroups, sizeof(Group), compareGroupKeys);
+    }
+    free(tables);
+    return full ? -1 : numGroups;
+}
+
+/* ---------------------------------------------------------------- */
+/* entry point                                                       */
+/* ---------------------------------------------------------------- */
+
+static inline int groupBy(KeyValue *pairs, int n, Group *groups, GroupByMethod method, int threads,
+                          GroupByMethod *used) {
+    if (threads > SORT_MAXTHREADS) threads = SORT_MAXTHREADS;
+    if (threads < 1) threads = 1;
+    double expected = estimateDistinct(pairs, n);
+    if (method == GROUPBY_AUTO || expected > HASH_MAX_KEYS) {
+        method = (expected <= HASH_MAX_KEYS) ? GROUPBY_HASH : GROUPBY_SORT;
+    }
+    if (method == GROUPBY_HASH) {
+        int numGroups = groupByHash(pairs, n, groups, expected, threads);
+        if (numGroups >= 0) {
+            if (used) *used = GROUPBY_HASH;
+            return numGroups;
+        }
+    }
+    if (used) *used = GROUPBY_SORT;
+    return groupBySort(pairs, n, groups, threads);
+}
+
+#endif /* GROUPBY_H */
@@ -0,0 +1,497 @@
+/* matrix summation with selectable parallelization strategies
+
+   features: one program for the strategies of matrixSum.c, the taskA/B/C
+             variants and the OpenMP versions. All of them call the same
+             row kernel on the same matrix, keep their partial results in
+             the same padded slots, are timed with the same clock, and
+             combine with the same rule (larger/smaller value, then the
+             earlier position), so the only thing that differs between
+             two timings is how the rows are handed out and the partial
+             results brought together.
+
+     static       pthreads, one strip each, main combines after joining
+     barrier      pthreads, one strip each, worker 0 combines after a
+                  barrier (matrixSum.c, taskA)
+     join         pthreads, one strip each, results handed back through
+                  pthread_join and combined as they arrive (taskB)
+     bag          pthreads, shared counter handing out chunks of rows
+                  under a mutex (taskC)
+     omp-static   OpenMP for with schedule(static, chunk)
+     omp-dynamic  OpenMP for with schedule(dynamic, chunk)
+     omp-guided   OpenMP for with schedule(guided, chunk)
+     steal        pthreads, each worker owns a range of rows and takes
+                  chunks from its front; an idle worker steals the back
+                  half of another worker's range
+     stdpar       std::transform_reduce, std::max_element and
+                  std::min_element with std::execution::par_unseq over the
+                  whole matrix (stdpar.cpp); only with -DHAVE_STDPAR
+     all          every strategy above, in turn
+
+   Each strategy runs once untimed, then runs times; the median is shown.
+
+   usage with gcc:
+     gcc -O2 -fopenmp -o matrixSum-engine matrixSum-engine.c -lpthread -lm
+     ./matrixSum-engine --strategy name --chunk rows --runs n --affinity spec size numWorkers seed
+
+   spec is none (the default), compact, scatter or a CPU list such as
+   0,2,4-7 (see affinity.h). pthread worker t and OpenMP thread t run on
+   the same CPU; the mapping is printed. numWorkers may be auto: the
+   cost model in autothreads.h then picks the count predicted to be
+   fastest for size (priced as pthreads, the costlier kind), down to 1.
+
+   with the C++17 parallel algorithms strategy (see stdpar.h):
+     g++ -O2 -std=c++17 -c stdpar.cpp
+     gcc -O2 -fopenmp -DHAVE_STDPAR -o matrixSum-engine matrixSum-engine.c stdpar.o -lpthread -lm -lstdc++ -ltbb
+*/
+
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#define _GNU_SOURCE
+#include <omp.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "affinity.h"
+#include "autothreads.h"
+#ifdef HAVE_STDPAR
+#include "stdpar.h"
+#endif
+
+#define MAXSIZE    10000  /* maximum matrix size */
+#define MAXWORKERS 16     /* maximum number of workers */
+#define MAXRUNS    101    /* maximum timed runs per strategy */
+#define CACHE_LINE 64
+
+/* a matrix element's value and position */
+typedef struct {
+  int row;
+  int col;
+  int value;
+} MatrixElement;
+
+/* partial or final result */
+typedef struct {
+  long long sum;
+  MatrixElement max;
+  MatrixElement min;
+} Result;
+
+/* one worker's result on its own cache lines */
+typedef struct {
+  Result result;
+  char pad[CACHE_LINE];
+} Slot;
+
+typedef void (*Strategy)(void);
+
+int size, numWorkers, chunk;
+int *matrix;                   /* size x size, row-major */
+Slot slots[MAXWORKERS];
+Result final;                  /* what the last run computed */
+
+/* ---------------------------------------------------------------- */
+/* shared kernel and combine                                         */
+/* ---------------------------------------------------------------- */
+
+static const Result emptyResult = { 0, { .value = INT_MIN }, { .value = INT_MAX } };
+
+/* fold rows [first, last] into r */
+static void reduceRows(int first, int last, Result *r) {
+  Result local = *r;
+  for (int i = first; i <= last; i++) {
+    const int *row = matrix + (size_t)i * size;
+    long long rowSum = 0;
+    for (int j = 0; j < size; j++) {
+      int v = row[j];
+      rowSum += v;
+      if (v > local.max.value) local.max = (MatrixElement){ i, j, v };
+      if (v < local.min.value) local.min = (MatrixElement){ i, j, v };
+    }
+    local.sum += rowSum;
+  }
+  *r = local;
+}
+
+static bool before(MatrixElement a, MatrixElement b) {
+  return a.row < b.row || (a.row == b.row && a.col < b.col);
+}
+
+/* merge b into a; ties go to the earlier position whatever the order */
+static void combine(Result *a, const Result *b) {
+  a->sum += b->sum;
+  if (b->max.value > a->max.value || (b->max.value == a->max.value && before(b->max, a->max)))
+    a->max = b->max;
+  if (b->min.value < a->min.value || (b->min.value == a->min.value && before(b->min, a->min)))
+    a->min = b->min;
+}
+
+static void stripOf(long id, int *first, int *last) {
+  int stripSize = size / numWorkers;
+  *first = id * stripSize;
+  *last = (id == numWorkers - 1) ? size - 1 : *first + stripSize - 1;
+}
+
+/* start numWorkers pthreads on worker and join them; the join results
+   are combined into final when collect is set */
+static void runThreads(void *(*worker)(void *), bool collect) {
+  pthread_t workers[MAXWORKERS];
+  for (long t = 0; t < numWorkers; t++) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    affinitySetAttr(&attr, t);
+    pthread_create(&workers[t], &attr, worker, (void *)t);
+    pthread_attr_destroy(&attr);
+  }
+  for (long t = 0; t < numWorkers; t++) {
+    void *returned;
+    pthread_join(workers[t], &returned);
+    if (collect) combine(&final, (Result *)returned);
+  }
+}
+
+/* ---------------------------------------------------------------- */
+/* static: strips, main combines the slots after joining             */
+/* ---------------------------------------------------------------- */
+
+static void *staticWorker(void *arg) {
+  long id = (long)arg;
+  int first, last;
+  stripOf(id, &first, &last);
+  slots[id].result = emptyResult;
+  reduceRows(first, last, &slots[id].result);
+  return NULL;
+}
+
+static void runStatic(void) {
+  runThreads(staticWorker, false);
+  final = emptyResult;
+  for (int t = 0; t < numWorkers; t++) combine(&final, &slots[t].result);
+}
+
+/* ---------------------------------------------------------------- */
+/* barrier: strips, worker 0 combines after a barrier                */
+/* ---------------------------------------------------------------- */
+
+pthread_mutex_t barrier = PTHREAD_MUTEX_INITIALIZER;  /* mutex lock for the barrier */
+pthread_cond_t go = PTHREAD_COND_INITIALIZER;         /* condition variable for leaving */
+int numArrived = 0;                                   /* number who have arrived */
+
+/* a reusable counter barrier */
+void Barrier() {
+  pthread_mutex_lock(&barrier);
+  numArrived++;
+  if (numArrived == numWorkers) {
+    numArrived = 0;
+    pthread_cond_broadcast(&go);
+  } else
+    pthread_cond_wait(&go, &barrier);
+  pthread_mutex_unlock(&barrier);
+}
+
+static void *barrierWorker(void *arg) {
+  long id = (long)arg;
+  int first, last;
+  stripOf(id, &first, &last);
+  slots[id].result = emptyResult;
+  reduceRows(first, last, &slots[id].result);
+  Barrier();
+  if (id == 0) {
+    final = emptyResult;
+    for (int t = 0; t < numWorkers; t++) combine(&final, &slots[t].result);
+  }
+  return NULL;
+}
+
+static void runBarrier(void) {
+  runThreads(barrierWorker, false);
+}
+
+/* ---------------------------------------------------------------- */
+/* join: strips, each result handed back through pthread_join        */
+/* ---------------------------------------------------------------- */
+
+static void *joinWorker(void *arg) {
+  long id = (long)arg;
+  int first, last;
+  stripOf(id, &first, &last);
+  slots[id].result = emptyResult;
+  reduceRows(first, last, &slots[id].result);
+  return &slots[id].result;
+}
+
+static void runJoin(void) {
+  final = emptyResult;
+  runThreads(joinWorker, true);
+}
+
+/* ---------------------------------------------------------------- */
+/* bag: a shared counter hands out chunks of rows                    */
+/* ---------------------------------------------------------------- */
+
+int nextRow;                      /* shared counter for the bag of tasks */
+pthread_mutex_t rowLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void *bagWorker(void *arg) {
+  long id = (long)arg;
+  slots[id].result = emptyResult;
+  while (1) {
+    pthread_mutex_lock(&rowLock);
+    int row = nextRow;
+    nextRow += chunk;
+    pthread_mutex_unlock(&rowLock);
+    if (row >= size) break;
+    int last = (row + chunk - 1 < size - 1) ? row + chunk - 1 : size - 1;
+    reduceRows(row, last, &slots[id].result);
+  }
+  return NULL;
+}
+
+static void runBag(void) {
+  nextRow = 0;
+  runThreads(bagWorker, false);
+  final = emptyResult;
+  for (int t = 0; t < numWorkers; t++) combine(&final, &slots[t].result);
+}
+
+/* ---------------------------------------------------------------- */
+/* OpenMP worksharing with the given schedule                        */
+/* ---------------------------------------------------------------- */
+
+static void runOmp(omp_sched_t kind) {
+  omp_set_schedule(kind, chunk);
+  final = emptyResult;
+#pragma omp parallel num_threads(numWorkers)
+  {
+    int id = omp_get_thread_num();
+    slots[id].result = emptyResult;
+#pragma omp for schedule(runtime)
+    for (int i = 0; i < size; i++)
+      reduceRows(i, i, &slots[id].result);
+#pragma omp critical
+    combine(&final, &slots[id].result);
+  }
+}
+
+static void runOmpStatic(void)  { runOmp(omp_sched_static); }
+static void runOmpDynamic(void) { runOmp(omp_sched_dynamic); }
+static void runOmpGuided(void)  { runOmp(omp_sched_guided); }
+
+/* ---------------------------------------------------------------- */
+/* steal: per-worker row ranges, idle workers steal half a range     */
+/* ---------------------------------------------------------------- */
+
+typedef struct {
+  pthread_mutex_t lock;
+  int next, end;                  /* rows [next, end) still to do */
+  char pad[CACHE_LINE];
+} RowRange;
+
+RowRange ranges[MAXWORKERS];
+
+/* take the back half of a victim's rows into my range */
+static bool steal(long id) {
+  for (int k = 1; k < numWorkers; k++) {
+    RowRange *victim = &ranges[(id + k) % numWorkers];
+    pthread_mutex_lock(&victim->lock);
+    int left = victim->end - victim->next;
+    if (left > chunk) {
+      int middle = victim->end - left / 2;
+      int end = victim->end;
+      victim->end = middle;
+      pthread_mutex_unlock(&victim->lock);
+
+      pthread_mutex_lock(&ranges[id].lock);
+      ranges[id].next = middle;
+      ranges[id].end = end;
+      pthread_mutex_unlock(&ranges[id].lock);
+      return true;
+    }
+    pthread_mutex_unlock(&victim->lock);
+  }
+  return false;
+}
+
+static void *stealWorker(void *arg) {
+  long id = (long)arg;
+  RowRange *mine = &ranges[id];
+  slots[id].result = emptyResult;
+  do {
+    while (1) {
+      pthread_mutex_lock(&mine->lock);
+      int row = mine->next;
+      int last = (row + chunk < mine->end) ? row + chunk : mine->end;
+      mine->next = last;
+      pthread_mutex_unlock(&mine->lock);
+      if (row >= last) break;
+      reduceRows(row, last - 1, &slots[id].result);
+    }
+  } while (steal(id));
+  return NULL;
+}
+
+static void runSteal(void) {
+  for (int t = 0; t < numWorkers; t++) {
+    int first, last;
+    stripOf(t, &first, &last);
+    pthread_mutex_init(&ranges[t].lock, NULL);
+    ranges[t].next = first;
+    ranges[t].end = last + 1;
+  }
+  runThreads(stealWorker, false);
+  final = emptyResult;
+  for (int t = 0; t < numWorkers; t++) {
+    combine(&final, &slots[t].result);
+    pthread_mutex_destroy(&ranges[t].lock);
+  }
+}
+
+#ifdef HAVE_STDPAR
+/* ---------------------------------------------------------------- */
+/* stdpar: the C++17 parallel algorithms over the flat matrix        */
+/* ---------------------------------------------------------------- */
+
+/* the library returns flat indices of the first max and min, which
+   are the earliest positions in row-major order, as combine wants */
+static void runStdpar(void) {
+  long long sum, maxAt, minAt;
+  stdparReduce(matrix, (long long)size * size, numWorkers, &sum, &maxAt, &minAt);
+  final.sum = sum;
+  final.max = (MatrixElement){ maxAt / size, maxAt % size, matrix[maxAt] };
+  final.min = (MatrixElement){ minAt / size, minAt % size, matrix[minAt] };
+}
+#endif
+
+/* ---------------------------------------------------------------- */
+/* driver                                                            */
+/* ---------------------------------------------------------------- */
+
+struct {
+  const char *name;
+  Strategy run;
+} strategies[] = {
+  { "static", runStatic },
+  { "barrier", runBarrier },
+  { "join", runJoin },
+  { "bag", runBag },
+  { "omp-static", runOmpStatic },
+  { "omp-dynamic", runOmpDynamic },
+  { "omp-guided", runOmpGuided },
+  { "steal", runSteal },
+#ifdef HAVE_STDPAR
+  { "stdpar", runStdpar },
+#endif
+};
+#define NUM_STRATEGIES (int)(sizeof(strategies) / sizeof(strategies[0]))
+
+static int compareDoubles(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/* one warm-up run, then the median of runs timed runs */
+static double timeStrategy(Strategy run, int runs) {
+  double times[MAXRUNS];
+  run();
+  for (int r = 0; r < runs; r++) {
+    double start_time = omp_get_wtime();
+    run();
+    times[r] = omp_get_wtime() - start_time;
+  }
+  qsort(times, runs, sizeof(double), compareDoubles);
+  return times[runs / 2];
+}
+
+static void usage(const char *program) {
+  printf("Usage: %s --strategy name --chunk rows --runs n --affinity spec size numWorkers|auto seed\n", program);
+  printf("Strategies:");
+  for (int s = 0; s < NUM_STRATEGIES; s++) printf(" %s", strategies[s].name);
+  printf(" all\n");
+}
+
+int main(int argc, char *argv[]) {
+  const char *strategy = "all", *affinity = "none";
+  int runs = 5, positional = 0, seed = -1;
+  bool autoMode = false;
+  chunk = 1;
+  size = MAXSIZE;
+  numWorkers = 4;
+
+  /* read command line args if any */
+  for (int a = 1; a < argc; a++) {
+    if (strcmp(argv[a], "--strategy") == 0 && a + 1 < argc) strategy = argv[++a];
+    else if (strcmp(argv[a], "--chunk") == 0 && a + 1 < argc) chunk = atoi(argv[++a]);
+    else if (strcmp(argv[a], "--runs") == 0 && a + 1 < argc) runs = atoi(argv[++a]);
+    else if (strcmp(argv[a], "--affinity") == 0 && a + 1 < argc) affinity = argv[++a];
+    else if (argv[a][0] == '-' && argv[a][1] == '-') { usage(argv[0]); return 1; }
+    else if (positional == 0) { size = atoi(argv[a]); positional++; }
+    else if (positional == 1) {
+      autoMode = strcmp(argv[a], "auto") == 0;
+      if (!autoMode) numWorkers = atoi(argv[a]);
+      positional++;
+    }
+    else if (positional == 2) { seed = atoi(argv[a]); positional++; }
+  }
+  if (size > MAXSIZE) size = MAXSIZE;
+  if (size < 1) size = 1;
+  if (autoMode) {
+    int procs = omp_get_num_procs();
+    numWorkers = autoThreads(WORK_SUM, (double)size * size, procs < MAXWORKERS ? procs : MAXWORKERS, true);
+  }
+  if (numWorkers > MAXWORKERS) numWorkers = MAXWORKERS;
+  if (numWorkers > size) numWorkers = size;
+  if (numWorkers < 1) numWorkers = 1;
+  if (chunk < 1) chunk = 1;
+  if (runs > MAXRUNS) runs = MAXRUNS;
+  if (runs < 1) runs = 1;
+
+  int chosen = -1;
+  for (int s = 0; s < NUM_STRATEGIES; s++)
+    if (strcmp(strategy, strategies[s].name) == 0) chosen = s;
+  if (chosen < 0 && strcmp(strategy, "all") != 0) {
+    usage(argv[0]);
+    return 1;
+  }
+  if (!affinityInit(affinity)) return 1;
+  affinityPinOpenMP(numWorkers);
+
+  /* the one matrix every strategy reads */
+  if (posix_memalign((void **)&matrix, CACHE_LINE, sizeof(int) * size * size) != 0) {
+    printf("Memory allocation error!\n");
+    return 1;
+  }
+  srand(seed >= 0 ? seed : time(NULL));
+  for (size_t k = 0; k < (size_t)size * size; k++)
+    matrix[k] = rand() % 100;
+
+  printf("Matrix %d x %d, %d workers, chunk %d, median of %d runs\n", size, size, numWorkers, chunk, runs);
+  if (autoMode) autoReport(WORK_SUM, (double)size * size, numWorkers, true);
+  affinityReport(numWorkers);
+#ifdef HAVE_STDPAR
+  printf("C++17 parallel algorithms on the %s backend\n", stdparBackend());
+#endif
+  printf("%-12s %12s %14s %22s %22s\n", "strategy", "time (s)", "total", "max (row, col)", "min (row, col)");
+
+  Result reference;
+  bool agree = true, first = true;
+  for (int s = 0; s < NUM_STRATEGIES; s++) {
+    if (chosen >= 0 && s != chosen) continue;
+    double time = timeStrategy(strategies[s].run, runs);
+    char maxText[32], minText[32];
+    snprintf(maxText, sizeof(maxText), "%d (%d, %d)", final.max.value, final.max.row, final.max.col);
+    snprintf(minText, sizeof(minText), "%d (%d, %d)", final.min.value, final.min.row, final.min.col);
+    printf("%-12s %12.6f %14lld %22s %22s\n", strategies[s].name, time, final.sum, maxText, minText);
+
+    if (first) reference = final;
+    else if (memcmp(&reference, &final, sizeof(Result)) != 0) agree = false;
+    first = false;
+  }
+  printf("Results agree? %s\n", agree ? "True" : "False");
+
+  free(matrix);
+  return 0;
+}
@@ -1,9 +1,12 @@
 /* matrix summation using OpenMP
 
    usage with gcc (version 4.2 or higher required):
-     gcc -O -fopenmp -o matrixSum-openmp matrixSum-openmp.c 
+     gcc -O -fopenmp -o matrixSum-openmp matrixSum-openmp.c -lm
      ./matrixSum-openmp size numWorkers
 
+   numWorkers auto lets the cost model in autothreads.h choose, 1 when
+   threads would lose.
+
 */
 
 #include <omp.h>
@@ -11,6 +14,7 @@
 double start_time, end_time;
 
 #include <stdio.h>
+#include "autothreads.h"
 #define MAXSIZE 10000  /* maximum matrix size */
 #define MAXWORKERS 8   /* maximum number of workers */
 
@@ -25,11 +29,14 @@ int main(int argc, char *argv[]) {
 
   /* read command line args if any */
   size = (argc > 1)? atoi(argv[1]) : MAXSIZE;
-  numWorkers = (argc > 2)? atoi(argv[2]) : MAXWORKERS;
   if (size > MAXSIZE) size = MAXSIZE;
+  int autoMode = (argc > 2) && strcmp(argv[2], "auto") == 0;
+  numWorkers = autoMode ? autoThreads(WORK_SUM, (double)size * size, MAXWORKERS, false)
+                        : (argc > 2)? atoi(argv[2]) : MAXWORKERS;
   if (numWorkers > MAXWORKERS) numWorkers = MAXWORKERS;
 
   omp_set_num_threads(numWorkers);
+  if (autoMode) autoReport(WORK_SUM, (double)size * size, numWorkers, false);
 
   /* initialize the matrix */
   for (i = 0; i < size; i++) {
@@ -0,0 +1,176 @@
+/* bandwidth benchmark for the scans in scan.h
+
+   For each element type (int32, int64, float) an array of n small
+   integers in [-8, 7] is scanned; the partial sums stay exact, so the
+   float scans must match a serial loop bit for bit despite their
+   different order of additions. Timed on the same input and output:
+
+     memcpy     the bandwidth ceiling: every element read once and
+                written once, as a scan must
+     loop       a plain serial inclusive scan
+     exclusive  scanX(..., SCAN_EXCLUSIVE, threads)
+     inclusive  scanX(..., SCAN_INCLUSIVE, threads)
+
+   Each gets one untimed warm-up run (which also faults the pages in),
+   then the median of the timed runs is reported as time, GB/s of bytes
+   read plus written, and the share of memcpy's bandwidth. Every scan is
+   checked against the serial loop.
+
+   usage with gcc:
+     gcc -O2 -fopenmp -o scan-engine scan-engine.c -lpthread -lm
+     ./scan-engine --threads n --runs r --type int32|int64|float|all --affinity spec size seed
+*/
+
+#define _GNU_SOURCE
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "affinity.h"
+#include "scan.h"
+
+#define MAXRUNS 101
+
+typedef enum { METHOD_MEMCPY, METHOD_LOOP, METHOD_EXCLUSIVE, METHOD_INCLUSIVE } Method;
+
+static const char *methodNames[] = { "memcpy", "loop", "exclusive", "inclusive" };
+#define NUM_METHODS (int)(sizeof(methodNames) / sizeof(methodNames[0]))
+
+/* fill, serial reference loop and parallel scan behind void pointers */
+#define SCAN_TYPE_FUNCTIONS(Name, Type)                                                  \
+static void fill##Name(void *input, long n) {                                            \
+    for (long i = 0; i < n; i++) ((Type *)input)[i] = (Type)(rand() % 16 - 8);           \
+}                                                                                        \
+static void loop##Name(const void *input, void *output, long n, ScanKind kind) {         \
+    const Type *in = (const Type *)input;                                                \
+    Type *out = (Type *)output, sum = 0;                                                 \
+    for (long i = 0; i < n; i++) {                                                       \
+        Type x = in[i];                                                                  \
+        if (kind == SCAN_EXCLUSIVE) out[i] = sum;                                        \
+        sum += x;                                                                        \
+        if (kind == SCAN_INCLUSIVE) out[i] = sum;                                        \
+    }                                                                                    \
+}                                                                                        \
+static void parallel##Name(const void *input, void *output, long n, ScanKind kind, int threads) { \
+    scan##Name((const Type *)input, (Type *)output, n, kind, threads);                   \
+}
+
+SCAN_TYPE_FUNCTIONS(Int32, int32_t)
+SCAN_TYPE_FUNCTIONS(Int64, int64_t)
+SCAN_TYPE_FUNCTIONS(Float, float)
+
+static const struct {
+    const char *name;
+    size_t size;
+    void (*fill)(void *input, long n);
+    void (*loop)(const void *input, void *output, long n, ScanKind kind);
+    void (*scan)(const void *input, void *output, long n, ScanKind kind, int threads);
+} scanTypes[] = {
+    { "int32", sizeof(int32_t), fillInt32, loopInt32, parallelInt32 },
+    { "int64", sizeof(int64_t), fillInt64, loopInt64, parallelInt64 },
+    { "float", sizeof(float), fillFloat, loopFloat, parallelFloat },
+};
+#define NUM_SCAN_TYPES (int)(sizeof(scanTypes) / sizeof(scanTypes[0]))
+
+static int compareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void usage(const char *program) {
+    printf("Usage: %s --threads n --runs r --type int32|int64|float|all --affinity spec size seed\n", program);
+}
+
+int main(int argc, char *argv[]) {
+    const char *typeName = "all", *affinity = "none";
+    int threads = omp_get_max_threads(), runs = 3, positional = 0, seed = -1;
+    long size = 1L << 24;
+
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--threads") == 0 && a + 1 < argc) threads = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--runs") == 0 && a + 1 < argc) runs = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--type") == 0 && a + 1 < argc) typeName = argv[++a];
+        else if (strcmp(argv[a], "--affinity") == 0 && a + 1 < argc) affinity = argv[++a];
+        else if (argv[a][0] == '-' && argv[a][1] == '-') { usage(argv[0]); return 1; }
+        else if (positional == 0) { size = atol(argv[a]); positional++; }
+        else if (positional == 1) { seed = atoi(argv[a]); positional++; }
+    }
+    if (size < 0) size = 0;
+    if (threads < 1) threads = 1;
+    if (threads > SCAN_MAXTHREADS) threads = SCAN_MAXTHREADS;
+    if (runs < 1) runs = 1;
+    if (runs > MAXRUNS) runs = MAXRUNS;
+
+    int chosen = -1;
+    for (int k = 0; k < NUM_SCAN_TYPES; k++) {
+        if (strcmp(typeName, scanTypes[k].name) == 0) chosen = k;
+    }
+    if (chosen < 0 && strcmp(typeName, "all") != 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (!affinityInit(affinity)) return 1;
+    affinityPinOpenMP(threads);
+
+    /* room for the widest type */
+    size_t bytes = sizeof(int64_t) * (size > 0 ? size : 1);
+    void *input = malloc(bytes), *output = malloc(bytes);
+    void *inclusive = malloc(bytes), *exclusive = malloc(bytes);
+    if (!input || !output || !inclusive || !exclusive) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+    srand(seed >= 0 ? seed : time(NULL));
+
+    printf("Elements: %ld, Threads: %d, Tile: %d, median of %d runs\n", size, threads, SCAN_TILE, runs);
+    affinityReport(threads);
+#ifdef __SSE2__
+    printf("In-tile scans on SSE2\n");
+#else
+    printf("In-tile scans scalar\n");
+#endif
+    printf("%-6s %-10s %12s %10s %10s %10s\n", "type", "method", "time (s)", "GB/s", "of memcpy", "correct?");
+
+    bool allCorrect = true;
+    for (int k = 0; k < NUM_SCAN_TYPES; k++) {
+        if (chosen >= 0 && chosen != k) continue;
+        size_t length = scanTypes[k].size * size;
+        scanTypes[k].fill(input, size);
+        scanTypes[k].loop(input, inclusive, size, SCAN_INCLUSIVE);
+        scanTypes[k].loop(input, exclusive, size, SCAN_EXCLUSIVE);
+
+        double memcpyRate = 0;
+        for (int m = 0; m < NUM_METHODS; m++) {
+            double times[MAXRUNS];
+            bool correct = true;
+            for (int r = -1; r < runs; r++) {
+                double start = omp_get_wtime();
+                switch ((Method)m) {
+                case METHOD_MEMCPY: memcpy(output, input, length); break;
+                case METHOD_LOOP: scanTypes[k].loop(input, output, size, SCAN_INCLUSIVE); break;
+                case METHOD_EXCLUSIVE: scanTypes[k].scan(input, output, size, SCAN_EXCLUSIVE, threads); break;
+                case METHOD_INCLUSIVE: scanTypes[k].scan(input, output, size, SCAN_INCLUSIVE, threads); break;
+                }
+                double elapsed = omp_get_wtime() - start;
+                const void *expected = (m == METHOD_MEMCPY) ? input
+                                     : (m == METHOD_EXCLUSIVE) ? exclusive : inclusive;
+                if (memcmp(output, expected, length) != 0) correct = false;
+                if (r >= 0) times[r] = elapsed;
+            }
+            qsort(times, runs, sizeof(double), compareDoubles);
+            double median = times[runs / 2];
+            double rate = (median > 0) ? 2.0 * length / median / 1e9 : 0;
+            if (m == METHOD_MEMCPY) memcpyRate = rate;
+            printf("%-6s %-10s %12.6f %10.2f %9.1f%% %10s\n", scanTypes[k].name, methodNames[m], median, rate,
+                   (memcpyRate > 0) ? 100 * rate / memcpyRate : 0, correct ? "True" : "False");
+            allCorrect = allCorrect && correct;
+        }
+    }
+
+    free(input);
+    free(output);
+    free(inclusive);
+    free(exclusive);
+    return allCorrect ? 0 : 1;
+}
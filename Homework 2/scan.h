@@ -0,0 +1,179 @@
+/* parallel prefix sums (scans) over int32, int64 and float arrays
+
+   scanInt32(in, out, n, kind, threads), and likewise scanInt64 and
+   scanFloat, write out[i] = in[0] + ... + in[i] (SCAN_INCLUSIVE) or
+   in[0] + ... + in[i - 1] (SCAN_EXCLUSIVE, out[0] = 0). out may be in.
+
+   Reduce-then-scan on the OpenMP team, as used by the sort engines, in
+   rounds of threads x SCAN_TILE elements: every thread sums its tile, one
+   thread turns the tile sums into offsets (carrying the running total from
+   round to round), and every thread then scans its tile, still in its
+   cache, starting from its offset. The input is read from memory once
+   and the output written once, as with memcpy; the tile is read twice,
+   the second time from cache. A thread only reads its own offset, so
+   the next round can start without another barrier. With one thread, or
+   no more than one tile, a single scan pass does it all.
+
+   Within a tile, the scan works on SSE2 vectors: log2(lanes) shifted
+   adds give the prefix sums of one vector, and the last lane carries on
+   into the next. Without SSE2 a scalar loop does the same.
+
+   Integer sums wrap around on overflow. Float sums are added in a
+   different order than a serial loop, so they agree with it only when
+   every partial sum is exact.
+*/
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <omp.h>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define SCAN_TILE       65536  /* elements per thread per round */
+#define SCAN_MAXTHREADS 64
+
+typedef enum { SCAN_EXCLUSIVE, SCAN_INCLUSIVE } ScanKind;
+
+/* ---------------------------------------------------------------- */
+/* tile kernels: sum, and scan starting from carry                   */
+/* ---------------------------------------------------------------- */
+
+static inline int32_t sumTileInt32(const int32_t *in, long n) {
+    uint32_t sum = 0;
+    for (long i = 0; i < n; i++) sum += (uint32_t)in[i];
+    return (int32_t)sum;
+}
+
+static inline void scanTileInt32(const int32_t *in, int32_t *out, long n, int32_t carry, ScanKind kind) {
+    long i = 0;
+#ifdef __SSE2__
+    __m128i running = _mm_set1_epi32(carry);
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128i local = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+        local = _mm_add_epi32(local, _mm_slli_si128(local, 8));
+        __m128i result = (kind == SCAN_INCLUSIVE) ? local : _mm_slli_si128(local, 4);
+        _mm_storeu_si128((__m128i *)(out + i), _mm_add_epi32(result, running));
+        running = _mm_add_epi32(running, _mm_shuffle_epi32(local, 0xFF));
+    }
+    carry = _mm_cvtsi128_si32(running);
+#endif
+    for (; i < n; i++) {
+        int32_t x = in[i];
+        if (kind == SCAN_EXCLUSIVE) out[i] = carry;
+        carry = (int32_t)((uint32_t)carry + (uint32_t)x);
+        if (kind == SCAN_INCLUSIVE) out[i] = carry;
+    }
+}
+
+static inline int64_t sumTileInt64(const int64_t *in, long n) {
+    uint64_t sum = 0;
+    for (long i = 0; i < n; i++) sum += (uint64_t)in[i];
+    return (int64_t)sum;
+}
+
+static inline void scanTileInt64(const int64_t *in, int64_t *out, long n, int64_t carry, ScanKind kind) {
+    long i = 0;
+#ifdef __SSE2__
+    __m128i running = _mm_set1_epi64x(carry);
+    for (; i + 2 <= n; i += 2) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128i local = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+        __m128i result = (kind == SCAN_INCLUSIVE) ? local : _mm_slli_si128(local, 8);
+        _mm_storeu_si128((__m128i *)(out + i), _mm_add_epi64(result, running));
+        running = _mm_add_epi64(running, _mm_shuffle_epi32(local, 0xEE));
+    }
+    carry = _mm_cvtsi128_si64(running);
+#endif
+    for (; i < n; i++) {
+        int64_t x = in[i];
+        if (kind == SCAN_EXCLUSIVE) out[i] = carry;
+        carry = (int64_t)((uint64_t)carry + (uint64_t)x);
+        if (kind == SCAN_INCLUSIVE) out[i] = carry;
+    }
+}
+
+static inline float sumTileFloat(const float *in, long n) {
+    long i = 0;
+    float sum = 0;
+#ifdef __SSE2__
+    __m128 lanes = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) lanes = _mm_add_ps(lanes, _mm_loadu_ps(in + i));
+    float partial[4];
+    _mm_storeu_ps(partial, lanes);
+    sum = (partial[0] + partial[1]) + (partial[2] + partial[3]);
+#endif
+    for (; i < n; i++) sum += in[i];
+    return sum;
+}
+
+static inline void scanTileFloat(const float *in, float *out, long n, float carry, ScanKind kind) {
+    long i = 0;
+#ifdef __SSE2__
+    __m128 running = _mm_set1_ps(carry);
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(in + i);
+        __m128 local = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+        local = _mm_add_ps(local, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(local), 8)));
+        __m128 result = (kind == SCAN_INCLUSIVE)
+                            ? local
+                            : _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(local), 4));
+        _mm_storeu_ps(out + i, _mm_add_ps(result, running));
+        running = _mm_add_ps(running, _mm_shuffle_ps(local, local, 0xFF));
+    }
+    carry = _mm_cvtss_f32(running);
+#endif
+    for (; i < n; i++) {
+        float x = in[i];
+        if (kind == SCAN_EXCLUSIVE) out[i] = carry;
+        carry += x;
+        if (kind == SCAN_INCLUSIVE) out[i] = carry;
+    }
+}
+
+/* ---------------------------------------------------------------- */
+/* the two passes, once per element type                             */
+/* ---------------------------------------------------------------- */
+
+#define SCAN_DEFINE(Name, Type, add)                                                         \
+static inline void scan##Name(const Type *in, Type *out, long n, ScanKind kind, int threads) { \
+    Type sums[SCAN_MAXTHREADS];                                                              \
+    Type total = 0;                                                                          \
+    if (threads > SCAN_MAXTHREADS) threads = SCAN_MAXTHREADS;                                \
+    if (threads < 1) threads = 1;                                                            \
+    if (n <= SCAN_TILE || threads == 1) {                                                    \
+        scanTile##Name(in, out, n, 0, kind);                                                 \
+        return;                                                                              \
+    }                                                                                        \
+    _Pragma("omp parallel num_threads(threads)")                                             \
+    {                                                                                        \
+        int t = omp_get_thread_num();                                                        \
+        int nt = omp_get_num_threads();                                                      \
+        for (long round = 0; round < n; round += (long)nt * SCAN_TILE) {                     \
+            long first = round + (long)t * SCAN_TILE;                                        \
+            if (first > n) first = n;                                                        \
+            long count = (n - first < SCAN_TILE) ? n - first : SCAN_TILE;                    \
+            sums[t] = sumTile##Name(in + first, count);                                      \
+            _Pragma("omp barrier")                                                           \
+            _Pragma("omp single")                                                            \
+            for (int u = 0; u < nt; u++) {                                                   \
+                Type sum = sums[u];                                                          \
+                sums[u] = total;                                                             \
+                total = add(total, sum);                                                     \
+            }                                                                                \
+            scanTile##Name(in + first, out + first, count, sums[t], kind);                   \
+        }                                                                                    \
+    }                                                                                        \
+}
+
+#define SCAN_ADD_WRAP32(a, b) (int32_t)((uint32_t)(a) + (uint32_t)(b))
+#define SCAN_ADD_WRAP64(a, b) (int64_t)((uint64_t)(a) + (uint64_t)(b))
+#define SCAN_ADD_FLOAT(a, b)  ((a) + (b))
+
+SCAN_DEFINE(Int32, int32_t, SCAN_ADD_WRAP32)
+SCAN_DEFINE(Int64, int64_t, SCAN_ADD_WRAP64)
+SCAN_DEFINE(Float, float, SCAN_ADD_FLOAT)
+
+#endif /* SCAN_H */
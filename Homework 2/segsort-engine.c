@@ -0,0 +1,157 @@
+/* benchmark driver for the segmented sort in segsort.h
+
+   One flat array is split into segments whose lengths are log-uniform in
+   [min, max] (or, with --rows, into the rows of a rows x cols matrix).
+   Three ways of sorting every segment are timed on fresh copies of it:
+
+     loop         serialQuicksort over the segments, one after another
+     per-segment  an OpenMP for with schedule(dynamic, 1), one
+                  serialQuicksort per segment, whatever its length
+     segmented    segmentedSort: networks, per-thread quicksorts and the
+                  parallel engine by segment length
+
+   Each gets one untimed warm-up run; the median of the timed runs is
+   reported and every run is checked against the loop.
+
+   usage with gcc:
+     gcc -O2 -fopenmp -o segsort-engine segsort-engine.c -lpthread -lm
+     ./segsort-engine --threads n --runs r --segments s --min a --max b seed
+     ./segsort-engine --threads n --runs r --rows rows cols seed
+*/
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "segsort.h"
+
+#define MAXRUNS 101
+
+typedef void (*SegmentedFunction)(int *array, const int *offsets, int numSegments, int threads);
+
+static void sortLoop(int *array, const int *offsets, int numSegments, int threads) {
+    (void)threads;
+    for (int s = 0; s < numSegments; s++) {
+        serialQuicksort(offsets[s], offsets[s + 1] - 1, array);
+    }
+}
+
+static void sortPerSegment(int *array, const int *offsets, int numSegments, int threads) {
+    #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+    for (int s = 0; s < numSegments; s++) {
+        serialQuicksort(offsets[s], offsets[s + 1] - 1, array);
+    }
+}
+
+static const struct {
+    const char *name;
+    SegmentedFunction sort;
+} methods[] = {
+    { "loop", sortLoop },
+    { "per-segment", sortPerSegment },
+    { "segmented", segmentedSort },
+};
+#define NUM_METHODS (int)(sizeof(methods) / sizeof(methods[0]))
+
+static int compareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void usage(const char *program) {
+    printf("Usage: %s --threads n --runs r --segments s --min a --max b seed\n", program);
+    printf("       %s --threads n --runs r --rows rows cols seed\n", program);
+}
+
+int main(int argc, char *argv[]) {
+    int threads = omp_get_max_threads(), runs = 3, seed = -1;
+    int numSegments = 1000, minLength = 1, maxLength = 200000, rows = 0, cols = 0;
+
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--threads") == 0 && a + 1 < argc) threads = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--runs") == 0 && a + 1 < argc) runs = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--segments") == 0 && a + 1 < argc) numSegments = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--min") == 0 && a + 1 < argc) minLength = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--max") == 0 && a + 1 < argc) maxLength = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--rows") == 0 && a + 2 < argc) {
+            rows = atoi(argv[++a]);
+            cols = atoi(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == '-') { usage(argv[0]); return 1; }
+        else seed = atoi(argv[a]);
+    }
+    if (threads < 1) threads = 1;
+    if (threads > SORT_MAXTHREADS) threads = SORT_MAXTHREADS;
+    if (runs < 1) runs = 1;
+    if (runs > MAXRUNS) runs = MAXRUNS;
+    if (rows > 0) numSegments = rows;
+    if (numSegments < 0) numSegments = 0;
+    if (minLength < 0) minLength = 0;
+    if (maxLength < minLength) maxLength = minLength;
+
+    srand(seed >= 0 ? seed : time(NULL));
+    int *offsets = (int *)malloc(sizeof(int) * (numSegments + 1));
+    if (!offsets) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+    offsets[0] = 0;
+    for (int s = 0; s < numSegments; s++) {
+        long length = (rows > 0) ? cols
+                    : (long)exp(log(minLength + 1) + (log(maxLength + 1) - log(minLength + 1)) * rand() / RAND_MAX) - 1;
+        if (length < 0) length = 0;
+        if (offsets[s] + length > INT_MAX) {
+            printf("Too many elements!\n");
+            return 1;
+        }
+        offsets[s + 1] = offsets[s] + (int)length;
+    }
+    int n = offsets[numSegments];
+
+    int *input = (int *)malloc(sizeof(int) * (n > 0 ? n : 1));
+    int *reference = (int *)malloc(sizeof(int) * (n > 0 ? n : 1));
+    int *work = (int *)malloc(sizeof(int) * (n > 0 ? n : 1));
+    if (!input || !reference || !work) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+    for (int i = 0; i < n; i++) input[i] = rand() % 1000000;
+    memcpy(reference, input, sizeof(int) * n);
+    sortLoop(reference, offsets, numSegments, 1);
+
+    int tiny = 0, medium = 0, huge = 0;
+    for (int s = 0; s < numSegments; s++) {
+        int length = offsets[s + 1] - offsets[s];
+        if (length > HUGE_SEGMENT) huge++;
+        else if (length > NETWORK_SIZE) medium++;
+        else if (length > 1) tiny++;
+    }
+    printf("Segments: %d (%d tiny, %d medium, %d huge), Elements: %d, Threads: %d, median of %d runs\n",
+           numSegments, tiny, medium, huge, n, threads, runs);
+    printf("%-14s %12s %10s\n", "method", "time (s)", "sorted?");
+
+    bool allCorrect = true;
+    for (int m = 0; m < NUM_METHODS; m++) {
+        double times[MAXRUNS];
+        bool correct = true;
+        for (int r = -1; r < runs; r++) {
+            memcpy(work, input, sizeof(int) * n);
+            double start = omp_get_wtime();
+            methods[m].sort(work, offsets, numSegments, threads);
+            double elapsed = omp_get_wtime() - start;
+            if (memcmp(work, reference, sizeof(int) * n) != 0) correct = false;
+            if (r >= 0) times[r] = elapsed;
+        }
+        qsort(times, runs, sizeof(double), compareDoubles);
+        printf("%-14s %12.6f %10s\n", methods[m].name, times[runs / 2], correct ? "True" : "False");
+        allCorrect = allCorrect && correct;
+    }
+
+    free(offsets);
+    free(input);
+    free(reference);
+    free(work);
+    return allCorrect ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+/* segmented sort: many variable-length segments of one array in one call
+
+   segmentedSort(array, offsets, numSegments, threads) sorts every segment
+   array[offsets[s] .. offsets[s + 1]) ascending in place, for example the
+   rows of a matrix stored row-major. Looping serialQuicksort over the
+   segments leaves the other cores idle, and a thread or task per segment
+   costs more than sorting a short one, so segments are first binned by
+   length and each bin gets the method that suits it:
+
+     tiny    up to NETWORK_SIZE elements: sorting networks, in place for
+             2 and 3 elements, otherwise on a local buffer padded with
+             INT_MAX to Batcher's odd-even merge network of 4, 8 or 16
+             inputs; handed out in chunks of TINY_CHUNK segments
+     medium  up to HUGE_SEGMENT elements: one serialQuicksort each, the
+             longest first, one segment at a time to whichever thread is
+             free (schedule(dynamic, 1))
+     huge    longer segments: the omp-cutoff engine of sortengine.h, its
+             tasks joining the same team
+
+   Everything runs in one parallel region: the huge segments are spawned
+   as tasks first, all threads then share the medium and tiny bins, and
+   threads that run out of those pick up tasks at the closing barrier.
+*/
+#ifndef SEGSORT_H
+#define SEGSORT_H
+
+#include <limits.h>
+#include "sortengine.h"
+
+#define NETWORK_SIZE  16       /* longest segment sorted by a network */
+#define TINY_CHUNK    256      /* tiny segments per worksharing chunk */
+#define HUGE_SEGMENT  THRESHOLD /* longer segments use the parallel engine */
+
+/* Batcher's odd-even merge sort networks for 4, 8 and 16 inputs, as
+   (i, j) pairs to compare and exchange; 5, 19 and 63 comparators */
+static const unsigned char network4[5][2] = {
+    { 0, 1 }, { 2, 3 }, { 0, 2 }, { 1, 3 }, { 1, 2 }
+};
+static const unsigned char network8[19][2] = {
+    { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 }, { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+    { 1, 2 }, { 5, 6 }, { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }, { 2, 4 }, { 3, 5 },
+    { 1, 2 }, { 3, 4 }, { 5, 6 }
+};
+static const unsigned char network16[63][2] = {
+    { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 }, { 8, 9 }, { 10, 11 }, { 12, 13 }, { 14, 15 },
+    { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 }, { 8, 10 }, { 9, 11 }, { 12, 14 }, { 13, 15 },
+    { 1, 2 }, { 5, 6 }, { 9, 10 }, { 13, 14 }, { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 },
+    { 8, 12 }, { 9, 13 }, { 10, 14 }, { 11, 15 }, { 2, 4 }, { 3, 5 }, { 10, 12 }, { 11, 13 },
+    { 1, 2 }, { 3, 4 }, { 5, 6 }, { 9, 10 }, { 11, 12 }, { 13, 14 }, { 0, 8 }, { 1, 9 },
+    { 2, 10 }, { 3, 11 }, { 4, 12 }, { 5, 13 }, { 6, 14 }, { 7, 15 }, { 4, 8 }, { 5, 9 },
+    { 6, 10 }, { 7, 11 }, { 2, 4 }, { 3, 5 }, { 6, 8 }, { 7, 9 }, { 10, 12 }, { 11, 13 },
+    { 1, 2 }, { 3, 4 }, { 5, 6 }, { 7, 8 }, { 9, 10 }, { 11, 12 }, { 13, 14 }
+};
+
+/* Branch-free compare and exchange */
+static inline void compareExchange(int *a, int i, int j) {
+    int x = a[i], y = a[j];
+    a[i] = (x < y) ? x : y;
+    a[j] = (x < y) ? y : x;
+}
+
+/* Run a network of count comparators over a */
+static inline void applyNetwork(int *a, const unsigned char (*network)[2], int count) {
+    for (int c = 0; c < count; c++) compareExchange(a, network[c][0], network[c][1]);
+}
+
+/* Sort 2 <= length <= NETWORK_SIZE elements: 2 and 3 in place, longer
+   ones padded with INT_MAX to the smallest network that fits */
+static inline void networkSort(int *segment, int length) {
+    int buffer[NETWORK_SIZE];
+    if (length <= 3) {
+        compareExchange(segment, 0, 1);
+        if (length == 3) {
+            compareExchange(segment, 1, 2);
+            compareExchange(segment, 0, 1);
+        }
+        return;
+    }
+    int width = (length <= 4) ? 4 : (length <= 8) ? 8 : 16;
+    for (int i = 0; i < width; i++) buffer[i] = (i < length) ? segment[i] : INT_MAX;
+    if (width == 4) applyNetwork(buffer, network4, 5);
+    else if (width == 8) applyNetwork(buffer, network8, 19);
+    else applyNetwork(buffer, network16, 63);
+    for (int i = 0; i < length; i++) segment[i] = buffer[i];
+}
+
+typedef struct {
+    int segment;
+    int length;
+} SegmentRef;
+
+/* Longer segments first */
+static inline int compareLonger(const void *a, const void *b) {
+    int x = ((const SegmentRef *)a)->length, y = ((const SegmentRef *)b)->length;
+    return (y > x) - (y < x);
+}
+
+static inline void segmentedSort(int *array, const int *offsets, int numSegments, int threads) {
+    SegmentRef *bins = (SegmentRef *)malloc(sizeof(SegmentRef) * (numSegments > 0 ? numSegments : 1));
+    int numTiny = 0, numMedium = 0, numHuge = 0;
+
+    /* without room for the bins, one serialQuicksort per segment */
+    if (!bins) {
+        #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+        for (int s = 0; s < numSegments; s++) {
+            serialQuicksort(offsets[s], offsets[s + 1] - 1, array);
+        }
+        return;
+    }
+
+    /* count, then lay the bins out back to back: tiny, medium, huge */
+    for (int s = 0; s < numSegments; s++) {
+        int length = offsets[s + 1] - offsets[s];
+        if (length > HUGE_SEGMENT) numHuge++;
+        else if (length > NETWORK_SIZE) numMedium++;
+        else if (length > 1) numTiny++;
+    }
+    SegmentRef *tiny = bins, *medium = bins + numTiny, *huge = medium + numMedium;
+    numTiny = numMedium = numHuge = 0;
+    for (int s = 0; s < numSegments; s++) {
+        SegmentRef ref = { s, offsets[s + 1] - offsets[s] };
+        if (ref.length > HUGE_SEGMENT) huge[numHuge++] = ref;
+        else if (ref.length > NETWORK_SIZE) medium[numMedium++] = ref;
+        else if (ref.length > 1) tiny[numTiny++] = ref;
+    }
+    qsort(medium, numMedium, sizeof(SegmentRef), compareLonger);
+
+    int maxDepth = 2 * spawnDepth(threads) + 2;
+    #pragma omp parallel num_threads(threads)
+    {
+        #pragma omp single nowait
+        for (int h = 0; h < numHuge; h++) {
+            int first = offsets[huge[h].segment];
+            #pragma omp task
+            cutoffQuicksort(first, first + huge[h].length - 1, 0, maxDepth, array, NULL);
+        }
+
+        #pragma omp for schedule(dynamic, 1) nowait
+        for (int m = 0; m < numMedium; m++) {
+            int first = offsets[medium[m].segment];
+            serialQuicksort(first, first + medium[m].length - 1, array);
+        }
+
+        #pragma omp for schedule(dynamic, TINY_CHUNK) nowait
+        for (int t = 0; t < numTiny; t++) {
+            networkSort(array + offsets[tiny[t].segment], tiny[t].length);
+        }
+    }
+    free(bins);
+}
+
+#endif /* SEGSORT_H */
@@ -0,0 +1,140 @@
+/* benchmark driver for the sort engines in sortengine.h
+
+   One random input is generated; every run of every engine sorts a fresh
+   copy of it, is timed with omp_get_wtime (wall clock, unlike clock(),
+   which adds up the CPU time of all threads), and is checked against a
+   reference sorted once with qsort. Each engine gets one untimed
+   warm-up run; the median of the timed runs is reported.
+
+   usage with gcc:
+     gcc -O2 -fopenmp -o sort-engine sort-engine.c -lpthread -lm
+     ./sort-engine --engine name --threads n --runs r --affinity spec size seed
+
+   name is one of the engines in sortengine.h, or all (the default).
+   spec is none (the default), compact, scatter or a CPU list such as
+   0,2,4-7 (see affinity.h); the chosen mapping is printed. --threads auto
+   takes the count the cost model in autothreads.h predicts to be
+   fastest for size, which may be 1.
+
+   with the C++17 parallel algorithms engine (see stdpar.h):
+     g++ -O2 -std=c++17 -c stdpar.cpp
+     gcc -O2 -fopenmp -DHAVE_STDPAR -o sort-engine sort-engine.c stdpar.o -lpthread -lm -lstdc++ -ltbb
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sortengine.h"
+#include "autothreads.h"
+
+#define MAXRUNS 101
+
+static int compareInts(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static int compareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Sort fresh copies of input runs times; returns the median time and
+   sets *correct to whether every run matched the reference */
+static double timeEngine(const SortEngine *engine, const int *input, const int *reference,
+                         int *work, int n, int threads, int runs, bool *correct) {
+    double times[MAXRUNS];
+    *correct = true;
+    for (int r = -1; r < runs; r++) {
+        memcpy(work, input, sizeof(int) * n);
+        double start = omp_get_wtime();
+        engine->sort(work, n, threads);
+        double elapsed = omp_get_wtime() - start;
+        if (memcmp(work, reference, sizeof(int) * n) != 0) *correct = false;
+        if (r >= 0) times[r] = elapsed;
+    }
+    qsort(times, runs, sizeof(double), compareDoubles);
+    return times[runs / 2];
+}
+
+static void usage(const char *program) {
+    printf("Usage: %s --engine name --threads n|auto --runs r --affinity spec size seed\n", program);
+    printf("Engines:");
+    for (int e = 0; e < NUM_SORT_ENGINES; e++) printf(" %s", sortEngines[e].name);
+    printf(" all\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *engineName = "all", *affinity = "none";
+    int threads = omp_get_max_threads(), runs = 3, positional = 0;
+    int size = 1000000, seed = -1;
+    bool autoMode = false;
+
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--engine") == 0 && a + 1 < argc) engineName = argv[++a];
+        else if (strcmp(argv[a], "--threads") == 0 && a + 1 < argc) {
+            autoMode = strcmp(argv[++a], "auto") == 0;
+            if (!autoMode) threads = atoi(argv[a]);
+        }
+        else if (strcmp(argv[a], "--runs") == 0 && a + 1 < argc) runs = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--affinity") == 0 && a + 1 < argc) affinity = argv[++a];
+        else if (argv[a][0] == '-' && argv[a][1] == '-') { usage(argv[0]); return 1; }
+        else if (positional == 0) { size = atoi(argv[a]); positional++; }
+        else if (positional == 1) { seed = atoi(argv[a]); positional++; }
+    }
+    if (size < 0) size = 0;
+    if (autoMode) {
+        int procs = omp_get_num_procs();
+        threads = autoThreads(WORK_SORT, size, procs < SORT_MAXTHREADS ? procs : SORT_MAXTHREADS, false);
+    }
+    if (threads < 1) threads = 1;
+    if (threads > SORT_MAXTHREADS) threads = SORT_MAXTHREADS;
+    if (runs < 1) runs = 1;
+    if (runs > MAXRUNS) runs = MAXRUNS;
+
+    const SortEngine *chosen = NULL;
+    if (strcmp(engineName, "all") != 0 && !(chosen = findSortEngine(engineName))) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (!affinityInit(affinity)) return 1;
+    affinityPinOpenMP(threads);
+
+    int *input = (int *)malloc(sizeof(int) * (size > 0 ? size : 1));
+    int *reference = (int *)malloc(sizeof(int) * (size > 0 ? size : 1));
+    int *work = (int *)malloc(sizeof(int) * (size > 0 ? size : 1));
+    if (!input || !reference || !work) {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+    srand(seed >= 0 ? seed : time(NULL));
+    for (int i = 0; i < size; i++) {
+        input[i] = rand() % ((size > 0 ? size : 1) * 10);
+    }
+    memcpy(reference, input, sizeof(int) * size);
+    qsort(reference, size, sizeof(int), compareInts);
+
+    printf("Array Size: %d, Threads: %d, median of %d runs\n", size, threads, runs);
+    if (autoMode) autoReport(WORK_SORT, size, threads, false);
+    affinityReport(threads);
+#ifdef HAVE_STDPAR
+    printf("C++17 parallel algorithms on the %s backend\n", stdparBackend());
+#endif
+    printf("%-14s %12s %10s\n", "engine", "time (s)", "sorted?");
+
+    bool allCorrect = true;
+    for (int e = 0; e < NUM_SORT_ENGINES; e++) {
+        if (chosen && chosen != &sortEngines[e]) continue;
+        bool correct;
+        double time = timeEngine(&sortEngines[e], input, reference, work, size, threads, runs, &correct);
+        printf("%-14s %12.6f %10s\n", sortEngines[e].name, time, correct ? "True" : "False");
+        allCorrect = allCorrect && correct;
+    }
+
+    free(input);
+    free(reference);
+    free(work);
+    return allCorrect ? 0 : 1;
+}
@@ -0,0 +1,581 @@
+/* sort engines for int arrays
+
+   Every engine has the signature void sort(int *array, int n, int threads)
+   and sorts array[0..n) ascending in place. They are collected in
+   sortEngines[] so a driver can pick one by name:
+
+     serial         median-of-three quicksort, the kernel all others fall
+                    back to below THRESHOLD
+     pthread-spawn  one pthread per partition down to a depth cap of
+                    log2(threads), as in the Homework 1 programs
+     pthread-pool   threads workers sharing a stack of ranges; a worker
+                    partitions a range, pushes one side and keeps the other
+     omp-tasks      one OpenMP task per side and a taskwait, as in
+                    Quicksort-openmp.c
+     omp-cutoff     one task for the smaller side while the spawning task
+                    loops on the larger one; no taskwait, the enclosing
+                    region waits once. Small ranges run undeferred (if),
+                    and ranges below FINAL_SIZE or past a depth of
+                    2 log2(threads) + 2 become final and sort serially
+     omp-taskloop   omp-cutoff, with ranges above PARALLEL_PARTITION
+                    partitioned by a taskloop: per-block counts, a
+                    prefix sum, a scatter into a scratch array and a copy
+                    back
+     sample         OpenMP sample sort: splitters from a sorted oversample,
+                    per-thread bucket counts, one scatter, then each
+                    thread sorts one bucket
+     radix          OpenMP LSD radix sort, four 8-bit passes with
+                    per-thread histograms
+     stdpar         std::sort with std::execution::par_unseq (stdpar.cpp);
+                    only registered when built with -DHAVE_STDPAR
+
+   The pthread engines start worker t on affinityMap's CPU for t (see
+   affinity.h), matching OpenMP thread t once a driver has called
+   affinityInit and affinityPinOpenMP; by default nothing is pinned.
+   An engine whose scratch memory cannot be allocated sorts serially in
+   place instead. Programs including this header must define _GNU_SOURCE
+   first.
+*/
+#ifndef SORTENGINE_H
+#define SORTENGINE_H
+
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+#include <omp.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "affinity.h"
+#ifdef HAVE_STDPAR
+#include "stdpar.h"
+#endif
+
+#define THRESHOLD       100000  /* ranges below this are sorted serially */
+#define SORT_MAXTHREADS 64
+#define OVERSAMPLE      64      /* sample elements per bucket in sample sort */
+#define RADIX_BITS      8
+#define TASK_IF_SIZE    10000    /* smaller ranges are not deferred */
+#define FINAL_SIZE      100000   /* smaller ranges are final tasks */
+#define PARALLEL_PARTITION 1000000 /* larger ranges partition with taskloop */
+#define PARTITION_BLOCKS 64
+#define RADIX_BUCKETS   (1 << RADIX_BITS)
+
+typedef void (*SortFunction)(int *array, int n, int threads);
+
+typedef struct {
+    const char *name;
+    SortFunction sort;
+} SortEngine;
+
+/* ---------------------------------------------------------------- */
+/* serial kernel                                                     */
+/* ---------------------------------------------------------------- */
+
+static inline void swap(int *a, int *b) {
+    int temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+/* Median-of-Three Pivot Selection */
+static inline int medianOfThree(int left, int right, int *array) {
+    int mid = left + (right - left) / 2;
+    if (array[left] > array[mid]) swap(&array[left], &array[mid]);
+    if (array[left] > array[right]) swap(&array[left], &array[right]);
+    if (array[mid] > array[right]) swap(&array[mid], &array[right]);
+    return mid;
+}
+
+/* Partition function for quicksort */
+static inline int partition(int left, int right, int *array) {
+    int pivotIndex = medianOfThree(left, right, array);
+    swap(&array[pivotIndex], &array[right]);
+    int pivot = array[right];
+    int i = left - 1;
+
+    for (int j = left; j < right; j++) {
+        if (array[j] < pivot) {
+            i++;
+            swap(&array[i], &array[j]);
+        }
+    }
+    swap(&array[i + 1], &array[right]);
+    return i + 1;
+}
+
+/* Serial Quicksort */
+static inline void serialQuicksort(int left, int right, int *array) {
+    if (left < right) {
+        int pivotIndex = partition(left, right, array);
+        serialQuicksort(left, pivotIndex - 1, array);
+        serialQuicksort(pivotIndex + 1, right, array);
+    }
+}
+
+static inline void sortSerial(int *array, int n, int threads) {
+    (void)threads;
+    serialQuicksort(0, n - 1, array);
+}
+
+/* ---------------------------------------------------------------- */
+/* pthread-spawn: a thread per partition down to a depth cap          */
+/* ---------------------------------------------------------------- */
+
+typedef struct {
+    int left;
+    int right;
+    int depth;
+    int worker;
+    int *array;
+} QuickSortTask;
+
+static inline void spawnQuicksort(int left, int right, int depth, int worker, int *array);
+
+static inline void *spawnQuicksortWorker(void *arg) {
+    QuickSortTask *task = (QuickSortTask *)arg;
+    spawnQuicksort(task->left, task->right, task->depth, task->worker, task->array);
+    return NULL;
+}
+
+/* The thread running as worker keeps the right side; the left side goes
+   to a new thread numbered worker + 2^(depth-1), so the 2^depth threads
+   of a full tree are workers 0 .. 2^depth - 1 for affinitySetAttr */
+static inline void spawnQuicksort(int left, int right, int depth, int worker, int *array) {
+    if (depth > 0 && (right - left) > THRESHOLD) {
+        int pivotIndex = partition(left, right, array);
+        pthread_t leftThread;
+        pthread_attr_t attr;
+        QuickSortTask task = { left, pivotIndex - 1, depth - 1, worker + (1 << (depth - 1)), array };
+        pthread_attr_init(&attr);
+        affinitySetAttr(&attr, task.worker);
+        pthread_create(&leftThread, &attr, spawnQuicksortWorker, &task);
+        pthread_attr_destroy(&attr);
+        spawnQuicksort(pivotIndex + 1, right, depth - 1, worker, array);
+        pthread_join(leftThread, NULL);
+    } else {
+        serialQuicksort(left, right, array);
+    }
+}
+
+/* Number of spawn levels needed to keep threads busy */
+static inline int spawnDepth(int threads) {
+    int depth = 0;
+    while ((1 << depth) < threads) depth++;
+    return depth;
+}
+
+static inline void sortPthreadSpawn(int *array, int n, int threads) {
+    spawnQuicksort(0, n - 1, spawnDepth(threads), 0, array);
+}
+
+/* ---------------------------------------------------------------- */
+/* pthread-pool: a fixed set of workers and a shared stack of ranges  */
+/* ---------------------------------------------------------------- */
+
+typedef struct {
+    int left, right;
+} SortRange;
+
+typedef struct {
+    int *array;
+    SortRange *stack;
+    int top, capacity;
+    int pending;              /* ranges pushed and not yet finished */
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} SortPool;
+
+/* False if the stack cannot grow; the caller then sorts the range itself */
+static inline bool poolPush(SortPool *pool, int left, int right) {
+    pthread_mutex_lock(&pool->lock);
+    if (pool->top == pool->capacity) {
+        SortRange *grown = (SortRange *)realloc(pool->stack, sizeof(SortRange) * pool->capacity * 2);
+        if (!grown) {
+            pthread_mutex_unlock(&pool->lock);
+            return false;
+        }
+        pool->stack = grown;
+        pool->capacity *= 2;
+    }
+    pool->stack[pool->top++] = (SortRange){ left, right };
+    pool->pending++;
+    pthread_cond_signal(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+    return true;
+}
+
+static inline void *poolWorker(void *arg) {
+    SortPool *pool = (SortPool *)arg;
+    while (1) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->top == 0 && pool->pending > 0) {
+            pthread_cond_wait(&pool->changed, &pool->lock);
+        }
+        if (pool->top == 0) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        SortRange range = pool->stack[--pool->top];
+        pthread_mutex_unlock(&pool->lock);
+
+        /* keep the right side, hand the left side to the pool */
+        while (range.right - range.left > THRESHOLD) {
+            int pivotIndex = partition(range.left, range.right, pool->array);
+            if (!poolPush(pool, range.left, pivotIndex - 1)) {
+                serialQuicksort(range.left, pivotIndex - 1, pool->array);
+            }
+            range.left = pivotIndex + 1;
+        }
+        serialQuicksort(range.left, range.right, pool->array);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) pthread_cond_broadcast(&pool->changed);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+static inline void sortPthreadPool(int *array, int n, int threads) {
+    pthread_t workers[SORT_MAXTHREADS];
+    SortPool pool = { array, NULL, 0, 64, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+    if (threads > SORT_MAXTHREADS) threads = SORT_MAXTHREADS;
+    if (threads < 2 || n <= THRESHOLD) {
+        serialQuicksort(0, n - 1, array);
+        return;
+    }
+    pool.stack = (SortRange *)malloc(sizeof(SortRange) * pool.capacity);
+    if (!pool.stack) {
+        serialQuicksort(0, n - 1, array);
+        return;
+    }
+    poolPush(&pool, 0, n - 1);
+    for (int t = 0; t < threads; t++) {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        affinitySetAttr(&attr, t);
+        pthread_create(&workers[t], &attr, poolWorker, &pool);
+        pthread_attr_destroy(&attr);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+    free(pool.stack);
+}
+
+/* ---------------------------------------------------------------- */
+/* omp-tasks: two tasks and a taskwait per partition                 */
+/* ---------------------------------------------------------------- */
+
+static inline void taskQuicksort(int left, int right, int *array) {
+    if (left < right) {
+        int pivotIndex = partition(left, right, array);
+        if ((right - left) > THRESHOLD) {
+            #pragma omp task
+            taskQuicksort(left, pivotIndex - 1, array);
+            #pragma omp task
+            taskQuicksort(pivotIndex + 1, right, array);
+            #pragma omp taskwait
+        } else {
+            serialQuicksort(left, pivotIndex - 1, array);
+            serialQuicksort(pivotIndex + 1, right, array);
+        }
+    }
+}
+
+static inline void sortOmpTasks(int *array, int n, int threads) {
+    #pragma omp parallel num_threads(threads)
+    {
+        #pragma omp single nowait
+        taskQuicksort(0, n - 1, array);
+    }
+}
+
+/* ---------------------------------------------------------------- */
+/* omp-cutoff and omp-taskloop: one task per level, if/final cutoffs  */
+/* ---------------------------------------------------------------- */
+
+/* Partition of [left, right] done by a taskloop over blocks: the same
+   pivot and split point as partition(), but each side keeps its input
+   order, where Lomuto permutes the side >= pivot */
+static inline int taskloopPartition(int left, int right, int *array, int *temp) {
+    int pivotIndex = medianOfThree(left, right, array);
+    swap(&array[pivotIndex], &array[right]);
+    int pivot = array[right];
+    long n = right - left;  /* elements left of the pivot slot */
+    long less[PARTITION_BLOCKS], lessBefore[PARTITION_BLOCKS], totalLess = 0;
+
+    #pragma omp taskloop grainsize(1) shared(less)
+    for (int b = 0; b < PARTITION_BLOCKS; b++) {
+        long count = 0;
+        for (long i = left + n * b / PARTITION_BLOCKS; i < left + n * (b + 1) / PARTITION_BLOCKS; i++) {
+            count += array[i] < pivot;
+        }
+        less[b] = count;
+    }
+    for (int b = 0; b < PARTITION_BLOCKS; b++) {
+        lessBefore[b] = totalLess;
+        totalLess += less[b];
+    }
+
+    #pragma omp taskloop grainsize(1) shared(lessBefore)
+    for (int b = 0; b < PARTITION_BLOCKS; b++) {
+        long first = left + n * b / PARTITION_BLOCKS;
+        long lo = left + lessBefore[b];
+        long hi = left + totalLess + (first - left - lessBefore[b]);
+        for (long i = first; i < left + n * (b + 1) / PARTITION_BLOCKS; i++) {
+            if (array[i] < pivot) temp[lo++] = array[i];
+            else temp[hi++] = array[i];
+        }
+    }
+
+    #pragma omp taskloop grainsize(1)
+    for (int b = 0; b < PARTITION_BLOCKS; b++) {
+        long first = left + n * b / PARTITION_BLOCKS, last = left + n * (b + 1) / PARTITION_BLOCKS;
+        memcpy(array + first, temp + first, sizeof(int) * (last - first));
+    }
+
+    swap(&array[left + totalLess], &array[right]);
+    return left + (int)totalLess;
+}
+
+/* temp is NULL unless large ranges should use taskloopPartition */
+static inline void cutoffQuicksort(int left, int right, int depth, int maxDepth, int *array, int *temp) {
+    while (right - left > 0) {
+        if (omp_in_final()) {
+            serialQuicksort(left, right, array);
+            return;
+        }
+        int pivotIndex = (temp && right - left > PARALLEL_PARTITION)
+                             ? taskloopPartition(left, right, array, temp)
+                             : partition(left, right, array);
+
+        /* spawn the smaller side, keep looping on the larger */
+        int smallLeft = left, smallRight = pivotIndex - 1;
+        if (pivotIndex - left > right - pivotIndex) {
+            smallLeft = pivotIndex + 1;
+            smallRight = right;
+            right = pivotIndex - 1;
+        } else {
+            left = pivotIndex + 1;
+        }
+        int small = smallRight - smallLeft;
+        depth++;
+        #pragma omp task if(small > TASK_IF_SIZE) final(small < FINAL_SIZE || depth >= maxDepth)
+        cutoffQuicksort(smallLeft, smallRight, depth, maxDepth, array, temp);
+
+        if (right - left < FINAL_SIZE || depth >= maxDepth) {
+            serialQuicksort(left, right, array);
+            return;
+        }
+    }
+}
+
+static inline void sortOmpCutoffWith(int *array, int n, int threads, int *temp) {
+    int maxDepth = 2 * spawnDepth(threads) + 2;
+    #pragma omp parallel num_threads(threads)
+    {
+        #pragma omp single nowait
+        cutoffQuicksort(0, n - 1, 0, maxDepth, array, temp);
+    }
+}
+
+static inline void sortOmpCutoff(int *array, int n, int threads) {
+    sortOmpCutoffWith(array, n, threads, NULL);
+}
+
+static inline void sortOmpTaskloop(int *array, int n, int threads) {
+    int *temp = (int *)malloc(sizeof(int) * (n > 0 ? n : 1));
+    if (!temp) {
+        /* without scratch every partition is the serial one */
+        sortOmpCutoffWith(array, n, threads, NULL);
+        return;
+    }
+    sortOmpCutoffWith(array, n, threads, temp);
+    free(temp);
+}
+
+/* ---------------------------------------------------------------- */
+/* sample sort                                                       */
+/* ---------------------------------------------------------------- */
+
+/* Bucket of x: the number of splitters <= x */
+static inline int bucketOf(int x, const int *splitters, int numSplitters) {
+    int low = 0, high = numSplitters;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (splitters[mid] <= x) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+static inline void sortSample(int *array, int n, int threads) {
+    if (threads > SORT_MAXTHREADS) threads = SORT_MAXTHREADS;
+    if (threads < 2 || n <= THRESHOLD) {
+        serialQuicksort(0, n - 1, array);
+        return;
+    }
+
+    /* splitters from a sorted, evenly spaced oversample */
+    int p = threads, sampleSize = p * OVERSAMPLE;
+    int *sample = (int *)malloc(sizeof(int) * sampleSize);
+    if (!sample) {
+        serialQuicksort(0, n - 1, array);
+        return;
+    }
+    uint32_t state = 2463534242u;
+    for (int s = 0; s < sampleSize; s++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        sample[s] = array[state % (uint32_t)n];
+    }
+    serialQuicksort(0, sampleSize - 1, sample);
+    int splitters[SORT_MAXTHREADS];
+    for (int b = 0; b < p - 1; b++) splitters[b] = sample[(b + 1) * OVERSAMPLE];
+    free(sample);
+
+    int *temp = (int *)malloc(sizeof(int) * n);
+    long *counts = (long *)calloc((size_t)p * p, sizeof(long));  /* counts[t * p + b] */
+    long bucketStart[SORT_MAXTHREADS + 1];
+    if (!temp || !counts) {
+        free(temp);
+        free(counts);
+        serialQuicksort(0, n - 1, array);
+        return;
+    }
+
+    #pragma omp parallel num_threads(p)
+    {
+        int t = omp_get_thread_num();
+        int nt = omp_get_num_threads();
+        long first = (long)n * t / nt, last = (long)n * (t + 1) / nt;
+
+        for (long i = first; i < last; i++) {
+            counts[t * p + bucketOf(array[i], splitters, p - 1)]++;
+        }
+        #pragma omp barrier
+
+        /* bucket-major, thread-minor offsets */
+        #pragma omp single
+        {
+            long offset = 0;
+            for (int b = 0; b < p; b++) {
+                bucketStart[b] = offset;
+                for (int u = 0; u < nt; u++) {
+                    long count = counts[u * p + b];
+                    counts[u * p + b] = offset;
+                    offset += count;
+                }
+            }
+            bucketStart[p] = offset;
+        }
+
+        for (long i = first; i < last; i++) {
+            int b = bucketOf(array[i], splitters, p - 1);
+            temp[counts[t * p + b]++] = array[i];
+        }
+        #pragma omp barrier
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int b = 0; b < p; b++) {
+            long start = bucketStart[b], length = bucketStart[b + 1] - start;
+            serialQuicksort(0, (int)length - 1, temp + start);
+            memcpy(array + start, temp + start, sizeof(int) * length);
+        }
+    }
+
+    free(counts);
+    free(temp);
+}
+
+/* ---------------------------------------------------------------- */
+/* radix sort                                                        */
+/* ---------------------------------------------------------------- */
+
+static inline void sortRadix(int *array, int n, int threads) {
+    if (threads > SORT_MAXTHREADS) threads = SORT_MAXTHREADS;
+    if (threads < 1) threads = 1;
+    int *temp = (int *)malloc(sizeof(int) * (n > 0 ? n : 1));
+    long *counts = (long *)malloc(sizeof(long) * threads * RADIX_BUCKETS);  /* counts[t * 256 + d] */
+    int *from = array, *to = temp;
+    if (!temp || !counts) {
+        free(temp);
+        free(counts);
+        serialQuicksort(0, n - 1, array);
+        return;
+    }
+
+    for (int shift = 0; shift < 32; shift += RADIX_BITS) {
+        #pragma omp parallel num_threads(threads)
+        {
+            int t = omp_get_thread_num();
+            int nt = omp_get_num_threads();
+            long first = (long)n * t / nt, last = (long)n * (t + 1) / nt;
+            long *mine = counts + (size_t)t * RADIX_BUCKETS;
+
+            /* flipping the sign bit makes the unsigned order the signed one */
+            memset(mine, 0, sizeof(long) * RADIX_BUCKETS);
+            for (long i = first; i < last; i++) {
+                mine[(((uint32_t)from[i] ^ 0x80000000u) >> shift) & (RADIX_BUCKETS - 1)]++;
+            }
+            #pragma omp barrier
+
+            /* digit-major, thread-minor offsets */
+            #pragma omp single
+            {
+                long offset = 0;
+                for (int d = 0; d < RADIX_BUCKETS; d++) {
+                    for (int u = 0; u < nt; u++) {
+                        long count = counts[(size_t)u * RADIX_BUCKETS + d];
+                        counts[(size_t)u * RADIX_BUCKETS + d] = offset;
+                        offset += count;
+                    }
+                }
+            }
+
+            for (long i = first; i < last; i++) {
+                to[mine[(((uint32_t)from[i] ^ 0x80000000u) >> shift) & (RADIX_BUCKETS - 1)]++] = from[i];
+            }
+        }
+        int *swapped = from;
+        from = to;
+        to = swapped;
+    }
+
+    /* an even number of passes leaves the result in array */
+    free(counts);
+    free(temp);
+}
+
+/* ---------------------------------------------------------------- */
+/* registry                                                          */
+/* ---------------------------------------------------------------- */
+
+static const SortEngine sortEngines[] = {
+    { "serial", sortSerial },
+    { "pthread-spawn", sortPthreadSpawn },
+    { "pthread-pool", sortPthreadPool },
+    { "omp-tasks", sortOmpTasks },
+    { "omp-cutoff", sortOmpCutoff },
+    { "omp-taskloop", sortOmpTaskloop },
+    { "sample", sortSample },
+    { "radix", sortRadix },
+#ifdef HAVE_STDPAR
+    { "stdpar", stdparSort },
+#endif
+};
+#define NUM_SORT_ENGINES (int)(sizeof(sortEngines) / sizeof(sortEngines[0]))
+
+/* The engine called name, or NULL */
+static inline const SortEngine *findSortEngine(const char *name) {
+    for (int e = 0; e < NUM_SORT_ENGINES; e++) {
+        if (strcmp(sortEngines[e].name, name) == 0) return &sortEngines[e];
+    }
+    return NULL;
+}
+
+#endif /* SORTENGINE_H */
@@ -0,0 +1,46 @@
+/* C++17 parallel algorithms backend, see stdpar.h
+
+   Nothing here is tuned: the point is to see how far the library gets
+   with the same inputs and thread counts as the hand-written engines.
+   With TBB the thread count is capped by a tbb::global_control for the
+   duration of each call; the serial backend ignores it.
+
+   std::minmax_element returns the last of several largest elements, while
+   every other strategy reports the first, so min_element and max_element
+   are called separately.
+*/
+
+#include <algorithm>
+#include <execution>
+#include <functional>
+#include "stdpar.h"
+
+#if defined(_PSTL_PAR_BACKEND_TBB)
+#include <tbb/global_control.h>
+#define STDPAR_LIMIT(threads) \
+    tbb::global_control limit(tbb::global_control::max_allowed_parallelism, (threads) > 0 ? (threads) : 1)
+#else
+#define STDPAR_LIMIT(threads) (void)(threads)
+#endif
+
+extern "C" const char *stdparBackend(void) {
+#if defined(_PSTL_PAR_BACKEND_TBB)
+    return "tbb";
+#else
+    return "serial";
+#endif
+}
+
+extern "C" void stdparSort(int *array, int n, int threads) {
+    STDPAR_LIMIT(threads);
+    std::sort(std::execution::par_unseq, array, array + n);
+}
+
+extern "C" void stdparReduce(const int *data, long long count, int threads,
+                             long long *sum, long long *maxIndex, long long *minIndex) {
+    STDPAR_LIMIT(threads);
+    *sum = std::transform_reduce(std::execution::par_unseq, data, data + count, 0LL,
+                                 std::plus<long long>(), [](int v) { return (long long)v; });
+    *maxIndex = std::max_element(std::execution::par_unseq, data, data + count) - data;
+    *minIndex = std::min_element(std::execution::par_unseq, data, data + count) - data;
+}
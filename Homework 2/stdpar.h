@@ -0,0 +1,37 @@
+/* C interface to the C++17 parallel algorithms backend in stdpar.cpp
+
+   The same workloads as the hand-written engines, run through std::sort,
+   std::transform_reduce and std::min_element/std::max_element with
+   std::execution::par_unseq. libstdc++ runs these on TBB when its headers
+   are found at compile time and serially otherwise; stdparBackend() says
+   which one was built.
+
+   usage with gcc, from a C driver:
+     g++ -O2 -std=c++17 -c stdpar.cpp
+     gcc -O2 -fopenmp -DHAVE_STDPAR -o sort-engine sort-engine.c stdpar.o -lpthread -lm -lstdc++ -ltbb
+
+   Leave out -ltbb when stdparBackend() is "serial".
+*/
+#ifndef STDPAR_H
+#define STDPAR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* "tbb" or "serial" */
+const char *stdparBackend(void);
+
+/* Sort array[0..n) ascending with at most threads workers */
+void stdparSort(int *array, int n, int threads);
+
+/* Sum of data[0..count) and the indices of its first largest and first
+   smallest element; count must be at least 1 */
+void stdparReduce(const int *data, long long count, int threads,
+                  long long *sum, long long *maxIndex, long long *minIndex);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STDPAR_H */